@@ -0,0 +1,88 @@
+// benchmark of the BGRA to RGBA conversion used for the PNG files of the OSD
+//
+// usage: bench-swizzle [width height]
+// like the encoder every row of the frame is converted into a reused
+// row buffer, the default is a full HD OSD
+
+#include "swizzle.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MINTIME 0.5 // s per kernel
+
+#define ELEMENTS(a) (int)(sizeof(a) / sizeof(a[0]))
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void Convert(uint8_t *Row, const uint8_t *Frame, int Width, int Height, eSwizzleKernel Kernel)
+{
+  for (int y = 0; y < Height; y++)
+      BgraToRgba(Row, Frame + y * Width * 4, Width, Kernel);
+}
+
+int main(int argc, char *argv[])
+{
+  int width = 1920;
+  int height = 1080;
+  if (argc == 3) {
+     width = atoi(argv[1]);
+     height = atoi(argv[2]);
+     }
+  if (((argc != 1) && (argc != 3)) || (width <= 0) || (height <= 0)) {
+     fprintf(stderr, "usage: %s [width height]\n", argv[0]);
+     return 1;
+     }
+
+  uint8_t *frame = (uint8_t*)malloc(width * height * 4);
+  uint8_t *row = (uint8_t*)malloc(width * 4);
+  uint8_t *expected = (uint8_t*)malloc(width * 4);
+  // some semi-transparent OSD, the values don't matter for the speed
+  srand(1);
+  for (int i = 0; i < width * height * 4; i++)
+      frame[i] = rand() & 0xff;
+
+  const uint8_t *last = frame + (height - 1) * width * 4;
+  BgraToRgba(expected, last, width, swizzleScalar);
+  for (int x = 0; x < width; x++) {
+      if ((expected[x * 4] != last[x * 4 + 2]) || (expected[x * 4 + 1] != last[x * 4 + 1]) || (expected[x * 4 + 2] != last[x * 4]) || (expected[x * 4 + 3] != last[x * 4 + 3])) {
+         printf("  scalar FAILED at pixel %d\n", x);
+         return 1;
+         }
+      }
+
+  const eSwizzleKernel kernels[] = { swizzleScalar, swizzleSsse3, swizzleNeon, swizzleAuto };
+  printf("BGRA to RGBA conversion of %dx%d pixels\n", width, height);
+  for (int k = 0; k < ELEMENTS(kernels); k++) {
+      if (!SwizzleKernelAvailable(kernels[k])) {
+         printf("  %-8s not available\n", SwizzleKernelName(kernels[k]));
+         continue;
+         }
+      Convert(row, frame, width, height, kernels[k]);
+      if (memcmp(row, expected, width * 4) != 0) {
+         printf("  %-8s FAILED: differs from the scalar conversion\n", SwizzleKernelName(kernels[k]));
+         return 1;
+         }
+      int rounds = 0;
+      double start = Now();
+      double elapsed = 0;
+      do {
+         Convert(row, frame, width, height, kernels[k]);
+         rounds++;
+         elapsed = Now() - start;
+         } while (elapsed < BENCH_MINTIME);
+      printf("  %-8s %8.3f ms/frame %8.1f MB/s\n", SwizzleKernelName(kernels[k]), elapsed * 1e3 / rounds, (double)rounds * width * height * 4 / elapsed / 1e6);
+      }
+
+  free(expected);
+  free(row);
+  free(frame);
+  return 0;
+}
@@ -0,0 +1,144 @@
+// benchmark of the UTF-8 validation used by cDBusHelper::ToUtf8
+//
+// usage: bench-utf8 [file ...]
+// every line of the files is one string, e.g. a channels.conf and a list
+// of recording names ("find /srv/vdr/video -name '*.rec'"),
+// without files a built-in corpus like that is used
+
+#include "utf8.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_MINTIME 0.5 // s per kernel
+
+static const char *Channels[] = {
+  "Das Erste HD;ARD:11494:HC23M5O35P0S1:S19.2E:22000:5101=27:5102=deu@3,5103=mis@3;5106=deu@106:5104;5105=deu:0:10301:1019:10301:0",
+  "ZDF HD;ZDFvision:11362:HC23M5O35P0S1:S19.2E:22000:6110=27:6120=deu@3,6121=mis@3,6123=mul@3;6122=deu@106:6130;6131=deu:0:11110:1011:11100:0",
+  "3sat HD;ZDFvision:11347:VC23M5O35P0S1:S19.2E:22000:6510=27:6520=deu@3,6521=mis@3;6522=deu@106:6530;6531=deu:0:11150:1011:11150:0",
+  "arte HD;ARD:11494:HC23M5O35P0S1:S19.2E:22000:5111=27:5112=deu@3,5113=fra@3;5116=deu@106:5114;5115=deu:0:10302:1019:10301:0",
+  "SRF 1 HD;SRG SSR:10971:HC23M5O35P0S1:S19.2E:29700:1279=27:1280=deu@3,1281=fra@3;1283=deu@106:1284;1285=deu:0:17000:1070:8500:0",
+  "ORF2W HD;ORF:11303:HC23M5O35P0S1:S19.2E:22000:3201=27:3202=deu@3;3203=deu@106:3205:D95,648:4920:1,1115:4920:0",
+  "Bayerisches FS Süd HD;ARD:11582:HC23M5O35P0S1:S19.2E:22000:5201=27:5202=deu@3,5203=mis@3;5206=deu@106:5204;5205=deu:0:10325:1025:10325:0",
+  "MDR Sachsen-Anhalt HD;ARD:10891:HC23M5O35P0S1:S19.2E:22000:5301=27:5302=deu@3;5306=deu@106:5304:0:10352:1051:10352:0",
+  "Schöner Reisen;Lagardère:12480:VC34M2S0:S19.2E:27500:1023=2:1024=deu@3:1025:0:53625:1:1079:0",
+  "Fußball Extra;Sky Deutschland:11914:HC910M5O35P0S1:S19.2E:27500:1023=27:1024=deu@3:1032:9C4,98C:129:133:1:0",
+  ":Öffentlich-rechtliche",
+  "N24 Doku;ProSiebenSat.1:12460:HC34M2S0:S19.2E:27500:1101=2:1102=deu@3:1104:0:17501:1:1107:0",
+};
+
+static const char *Recordings[] = {
+  "/srv/vdr/video/Tatort/Münster~Das_Team/2023-05-14.20.13.3-0.rec",
+  "/srv/vdr/video/Dokumentation/Terra_X/Die_Kinder_der_Römer/2024-01-07.19.28.4-0.rec",
+  "/srv/vdr/video/Spielfilm/Die_fabelhafte_Welt_der_Amélie/2022-12-26.22.00.12-0.rec",
+  "/srv/vdr/video/Sport/Fußball~Länderspiel_Deutschland_-_Österreich/2024-06-03.20.40.2-0.rec",
+  "/srv/vdr/video/Serien/Der_Bergdoktor/Staffel_16~Auf_dünnem_Eis/2023-02-09.20.15.1-0.rec",
+  "/srv/vdr/video/Nachrichten/Tagesschau/2024-03-01.20.00.1-0.rec",
+  "/srv/vdr/video/Kinder/Die_Sendung_mit_der_Maus/2024-02-25.11.30.5-0.rec",
+  "/srv/vdr/video/Spielfilm/Das_Boot/2021-11-20.20.15.7-0.rec",
+  // names from old EPG data in ISO-8859-1, they aren't valid UTF-8
+  "/srv/vdr/video/Spielfilm/Die_S\xfc""dsee-Insel/2011-08-13.14.00.3-0.rec",
+  "/srv/vdr/video/Serien/Sch\xf6ne_Aussichten/2012-03-02.18.45.9-0.rec",
+};
+
+#define ELEMENTS(a) (int)(sizeof(a) / sizeof(a[0]))
+
+static double Now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int Count = 0;
+static int Size = 0;
+static char **Strings = NULL;
+
+static void Add(const char *String)
+{
+  if ((Count % 1024) == 0)
+     Strings = (char**)realloc(Strings, (Count + 1024) * sizeof(char*));
+  // each string is allocated on its own like the cStrings of the plugin
+  Strings[Count++] = strdup(String);
+  Size += strlen(String);
+}
+
+static bool LoadFile(const char *FileName)
+{
+  FILE *f = fopen(FileName, "r");
+  if (f == NULL) {
+     perror(FileName);
+     return false;
+     }
+  char *line = NULL;
+  size_t size = 0;
+  ssize_t len;
+  while ((len = getline(&line, &size, f)) > 0) {
+        if (line[len - 1] == '\n')
+           line[len - 1] = 0;
+        Add(line);
+        }
+  free(line);
+  fclose(f);
+  return true;
+}
+
+static void BuiltinCorpus(void)
+{
+  // about the size of a channels.conf with all satellites and a big video directory
+  char buffer[512];
+  for (int i = 0; i < 1500; i++) {
+      snprintf(buffer, sizeof(buffer), "%s", Channels[i % ELEMENTS(Channels)]);
+      Add(buffer);
+      }
+  for (int i = 0; i < 3000; i++) {
+      snprintf(buffer, sizeof(buffer), "%s", Recordings[i % ELEMENTS(Recordings)]);
+      Add(buffer);
+      }
+}
+
+int main(int argc, char *argv[])
+{
+  for (int i = 1; i < argc; i++) {
+      if (!LoadFile(argv[i]))
+         return 1;
+      }
+  if (Count == 0)
+     BuiltinCorpus();
+
+  const eUtf8Kernel kernels[] = { utf8Bytewise, utf8Scalar, utf8Sse2, utf8Avx2, utf8Auto };
+  int expected = -1;
+  printf("UTF-8 validation of %d strings, %d bytes\n", Count, Size);
+  for (int k = 0; k < ELEMENTS(kernels); k++) {
+      if (!Utf8KernelAvailable(kernels[k])) {
+         printf("  %-8s not available\n", Utf8KernelName(kernels[k]));
+         continue;
+         }
+      int valid = 0;
+      for (int i = 0; i < Count; i++)
+          valid += Utf8IsValid(Strings[i], kernels[k]);
+      if (expected < 0)
+         expected = valid;
+      else if (valid != expected) {
+         printf("  %-8s FAILED: %d valid strings instead of %d\n", Utf8KernelName(kernels[k]), valid, expected);
+         return 1;
+         }
+      int rounds = 0;
+      double start = Now();
+      double elapsed = 0;
+      do {
+         for (int i = 0; i < Count; i++)
+             valid += Utf8IsValid(Strings[i], kernels[k]);
+         rounds++;
+         elapsed = Now() - start;
+         } while (elapsed < BENCH_MINTIME);
+      printf("  %-8s %8.1f ns/string %8.1f MB/s (%d valid)\n", Utf8KernelName(kernels[k]), elapsed * 1e9 / ((double)rounds * Count), (double)rounds * Size / elapsed / 1e6, expected);
+      }
+
+  for (int i = 0; i < Count; i++)
+      free(Strings[i]);
+  free(Strings);
+  return 0;
+}
@@ -0,0 +1,57 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# checks that the ids returned by timer.NewBatch can be passed to
+# timer.DeleteBatch, even after another timer has been deleted
+# the test timers are inactive and are deleted at the end
+
+import dbus
+import sys
+import datetime
+
+instance = ''
+if len(sys.argv) > 1:
+  instance = sys.argv[1]
+
+bus = dbus.SystemBus()
+Timers = bus.get_object('de.tvdr.vdr{0}'.format(instance), '/Timers')
+Channels = bus.get_object('de.tvdr.vdr{0}'.format(instance), '/Channels')
+
+def ids():
+  return [int(t[0]) for t in Timers.ListDetailed(dbus_interface = 'de.tvdr.vdr.timer')]
+
+def newbatch(count):
+  channel = Channels.List('1', dbus_interface = 'de.tvdr.vdr.channel')[0][0][0]
+  day = (datetime.date.today() + datetime.timedelta(days = 30)).isoformat()
+  timers = []
+  for i in range(count):
+    timers.append('0:{0}:{1}:0300:0400:50:99:dbus2vdr-check-{2}:'.format(channel, day, i))
+  (code, message, newids) = Timers.NewBatch(timers, dbus_interface = 'de.tvdr.vdr.timer')
+  if code != 250:
+    print u"NewBatch failed: {0} {1}".format(code, message)
+    sys.exit(1)
+  return [int(i) for i in newids]
+
+def deletebatch(delids):
+  (code, message) = Timers.DeleteBatch(dbus.Array(delids, signature = 'i'), dbus_interface = 'de.tvdr.vdr.timer')
+  if code != 250:
+    print u"DeleteBatch {0} failed: {1} {2}".format(delids, code, message)
+    sys.exit(1)
+
+# the first batch leaves a gap between the indexes and the ids
+first = newbatch(2)
+deletebatch([first[0]])
+
+second = newbatch(2)
+for i in second:
+  if i not in ids():
+    print u"id {0} of NewBatch is not listed by ListDetailed".format(i)
+    sys.exit(1)
+deletebatch([second[0]])
+remaining = ids()
+if second[0] in remaining or second[1] not in remaining or first[1] not in remaining:
+  print u"DeleteBatch {0} deleted the wrong timer".format(second[0])
+  sys.exit(1)
+
+deletebatch([first[1], second[1]])
+print u"ok"
@@ -34,6 +34,8 @@ namespace cDBusChannelsHelper
     "  </interface>\n"
     "</node>\n";
 
+  static cDBusListIndex<cChannel> _index;
+
   static void AddChannel(GVariantBuilder *Array, const cChannel *Channel)
   {
     if (Channel == NULL)
@@ -107,12 +109,14 @@ namespace cDBusChannelsHelper
 #else
     channels = &Channels;
 #endif
-    const cChannel *c = channels->Get(from_index);
-    while ((c != NULL) && (to_index >= from_index)) {
-       cDBusChannelsHelper::AddChannel(array, c);
-       c = channels->Next(c);
-       to_index--;
-       }
+    cDBusListIndex<cChannel>::cLock IndexLock(_index);
+    _index.Update(channels);
+    for (int i = from_index; i <= to_index; i++) {
+        const cChannel *c = _index.Get(i);
+        if (c == NULL)
+           break;
+        cDBusChannelsHelper::AddChannel(array, c);
+        }
 
     GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(a(is))"));
     g_variant_builder_add_value(builder, g_variant_builder_end(array));
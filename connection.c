@@ -169,6 +169,26 @@ void  cDBusConnection::EmitSignal(cDBusSignal *Signal)
   g_mutex_unlock(&_flush_mutex);
 }
 
+void  cDBusConnection::EmitSignal(cList<cDBusSignal> &Signals)
+{
+  if (Signals.Count() == 0)
+     return;
+  g_mutex_lock(&_flush_mutex);
+  bool addHandler = (_signals.Count() == 0);
+  while (cDBusSignal *s = Signals.First()) {
+        Signals.Del(s, false);
+        s->_connection = this;
+        _signals.Add(s);
+        }
+  if (addHandler) {
+     GSource *source = g_idle_source_new();
+     g_source_set_priority(source, G_PRIORITY_DEFAULT);
+     g_source_set_callback(source, do_emit_signal, this, NULL);
+     g_source_attach(source, _context);
+     }
+  g_mutex_unlock(&_flush_mutex);
+}
+
 void  cDBusConnection::CallMethod(cDBusMethodCall *Call)
 {
   g_mutex_lock(&_flush_mutex);
@@ -680,6 +700,8 @@ void  cDBusConnection::do_call_reply(GObject *source_object, GAsyncResult *res,
      err = NULL;
      }
   call->_on_reply(reply, call->_on_reply_user_data);
+  if (reply != NULL)
+     g_variant_unref(reply);
   delete call;
 }
 
@@ -210,6 +210,8 @@ public:
 
   // "Signal" and "Call" objects will be deleted by cDBusConnection
   void  EmitSignal(cDBusSignal *Signal);
+  // moves all signals of the list into the queue at once
+  void  EmitSignal(cList<cDBusSignal> &Signals);
   void  CallMethod(cDBusMethodCall *Call);
   void  Subscribe(cDBusSignal *Signal);
   void  Unsubscribe(cDBusSignal *Signal);
@@ -24,6 +24,9 @@
 #include "plugin.h"
 #include "osd.h"
 #include "recording.h"
+#include "recordingcache.h"
+#include "recordingjob.h"
+#include "recordingscanner.h"
 #include "remote.h"
 #include "sd-daemon.h"
 #include "setup.h"
@@ -260,8 +263,19 @@ const char *cPluginDbus2vdr::CommandLineHelp(void)
          "    usually it's /usr/share/vdr/shutdown-hooks\n"
          "  --shutdown-hooks-wrapper=/path/to/shutdown-hooks-wrapper\n"
          "    path to a program that will call the shutdown-hooks with suid\n"
-         "  --osd\n"
+         "  --osd[=files|shm]\n"
          "    creates an OSD provider which will save the OSD as PNG files\n"
+         "    or with \"shm\" draw it into a framebuffer in shared memory\n"
+         "  --osd-encoder=raw|qoi|zlib[:level]|png[:fast]\n"
+         "    file format of the OSD provider, default is png\n"
+         "  --osd-fps=n\n"
+         "    max. number of images per second and OSD, default is unlimited\n"
+         "  --osd-keep=n\n"
+         "    number of image files per viewport of an OSD which are reused in turn,\n"
+         "    default is 16\n"
+         "    with 0 all files are kept until the OSD is closed\n"
+         "  --osd-dir=/path/to/dir\n"
+         "    directory for the image files, default is /tmp/dbus2vdr\n"
          "  --systemd\n"
          "    use sd_notify to notify systemd\n"
          "  --upstart\n"
@@ -290,7 +304,11 @@ bool cPluginDbus2vdr::ProcessArgs(int argc, char *argv[])
   {
     {"shutdown-hooks", required_argument, 0, 's'},
     {"shutdown-hooks-wrapper", required_argument, 0, 'w'},
-    {"osd", no_argument, 0, 'o'},
+    {"osd", optional_argument, 0, 'o'},
+    {"osd-encoder", required_argument, 0, 'o' | 0x100},
+    {"osd-fps", required_argument, 0, 'o' | 0x200},
+    {"osd-keep", required_argument, 0, 'o' | 0x400},
+    {"osd-dir", required_argument, 0, 'o' | 0x800},
     {"upstart", no_argument, 0, 'u'},
     {"session", no_argument, 0, 's' | 0x100},
     {"no-system", no_argument, 0, 's' | 0x200},
@@ -315,8 +333,52 @@ bool cPluginDbus2vdr::ProcessArgs(int argc, char *argv[])
            }
           case 'o':
            {
+             if (!cDBusOsdProvider::SetDefaultMode(optarg)) {
+                esyslog("dbus2vdr: unknown osd mode %s", optarg);
+                return false;
+                }
              _enable_osd = true;
-             isyslog("dbus2vdr: enable osd");
+             isyslog("dbus2vdr: enable osd%s%s", optarg ? " with mode " : "", optarg ? optarg : "");
+             break;
+           }
+          case 'o' | 0x100:
+           {
+             if (!cDBusOsdProvider::SetDefaultEncoder(optarg)) {
+                esyslog("dbus2vdr: unknown osd encoder %s", optarg);
+                return false;
+                }
+             isyslog("dbus2vdr: use osd encoder %s", optarg);
+             break;
+           }
+          case 'o' | 0x200:
+           {
+             int fps = atoi(optarg);
+             if (fps < 0) {
+                esyslog("dbus2vdr: invalid osd fps %s", optarg);
+                return false;
+                }
+             cDBusOsdProvider::SetMaxFps(fps);
+             isyslog("dbus2vdr: limit osd to %d fps", fps);
+             break;
+           }
+          case 'o' | 0x400:
+           {
+             int keep = atoi(optarg);
+             if (keep < 0) {
+                esyslog("dbus2vdr: invalid number of osd files %s", optarg);
+                return false;
+                }
+             cDBusOsdProvider::SetKeepFiles(keep);
+             isyslog("dbus2vdr: keep %d files per osd viewport", keep);
+             break;
+           }
+          case 'o' | 0x800:
+           {
+             if (!cDBusOsdProvider::SetDirectory(optarg)) {
+                esyslog("dbus2vdr: osd directory %s must be an absolute path", optarg);
+                return false;
+                }
+             isyslog("dbus2vdr: write osd files to %s", cDBusOsdProvider::Directory());
              break;
            }
           case 's':
@@ -410,6 +472,7 @@ bool cPluginDbus2vdr::Initialize(void)
 bool cPluginDbus2vdr::Start(void)
 {
   cDBusHelper::SetConfigDirectory(cPlugin::ConfigDirectory("dbus2vdr"));
+  cDBusRecordingCache::Init(cDBusHelper::ConfigDirectory());
   // Start any background activities the plugin shall perform.
   if (_enable_mainloop) {
      _main_loop = new cDBusMainLoop(NULL);
@@ -448,6 +511,7 @@ bool cPluginDbus2vdr::Start(void)
 void cPluginDbus2vdr::Stop(void)
 {
   cDBusRemote::MainMenuAction = NULL;
+  cDBusRemote::StopMacros();
 
   // emit status "Stop" on the various notification channels
   if (_enable_systemd)
@@ -465,6 +529,9 @@ void cPluginDbus2vdr::Stop(void)
      _system_bus = NULL;
      }
   cDBusObject::FreeThreadPool();
+  cDBusRecordingJobs::Shutdown();
+  cDBusRecordingScanner::Shutdown();
+  cDBusRecordingCache::Shutdown();
   cDBusConnection::FreeThreadPool();
   if (_main_loop != NULL) {
      cPluginManager::CallAllServices("dbus2vdr-MainLoopStopped", NULL);
@@ -500,6 +567,8 @@ void cPluginDbus2vdr::MainThreadHook(void)
      cControl::Shutdown();
      cDevice::SetPrimaryDevice(requestPrimaryDevice + 1);
      }
+
+  cDBusSetup::CheckChanges();
 }
 
 cString cPluginDbus2vdr::Active(void)
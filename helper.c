@@ -1,5 +1,6 @@
 #include "helper.h"
 #include "common.h"
+#include "utf8.h"
 
 #include <dbus/dbus.h>
 #include <vdr/plugin.h>
@@ -11,56 +12,49 @@ cString  cDBusHelper::_pluginConfigDir;
 
 bool cDBusHelper::IsValidUtf8(const char *text)
 {
-  int na = 0;
-  int nb = 0;
-  const char *c;
-  
-  for (c = text; *c; c += (nb + 1)) {
-      if ((*c & 0x80) == 0x00)
-         nb = 0;
-      else if ((*c & 0xc0) == 0x80)
-         return false;
-      else if ((*c & 0xe0) == 0xc0)
-         nb = 1;
-      else if ((*c & 0xf0) == 0xe0)
-         nb = 2;
-      else if ((*c & 0xf8) == 0xf0)
-         nb = 3;
-      else if ((*c & 0xfc) == 0xf8)
-         nb = 4;
-      else if ((*c & 0xfe) == 0xfc)
-         nb = 5;
-      for (na = 1; *(c + na) && (na <= nb); na++) {
-          if ((*(c + na) & 0xc0) != 0x80)
-             return false;
-          }
-      }
-  return true;
+  return Utf8IsValid(text);
 }
 
+static const char *FromCharSet(void)
+{
+  const char *charSetOverride = getenv("VDR_CHARSET_OVERRIDE");
+  if (charSetOverride)
+     return charSetOverride;
+  return "ISO6937";
+}
+
+// every dispatch thread gets its own converter, so they don't block each other
+static void DeleteConverter(gpointer data)
+{
+  delete (cCharSetConv*)data;
+}
+
+static GPrivate fromIso6937Converter = G_PRIVATE_INIT(DeleteConverter);
+static GPrivate toUtf8Converter = G_PRIVATE_INIT(DeleteConverter);
+
 void cDBusHelper::ToUtf8(cString &text)
 {
   if ((cCharSetConv::SystemCharacterTable() == NULL) || (strcmp(cCharSetConv::SystemCharacterTable(), "UTF-8") == 0)) {
      if (!cDBusHelper::IsValidUtf8(*text)) {
-        static const char *fromCharSet = "ISO6937";
-        static const char *charSetOverride = getenv("VDR_CHARSET_OVERRIDE");
-        if (charSetOverride)
-           fromCharSet = charSetOverride;
-        d4syslog("dbus2vdr: ToUtf8: create charset converter from %s to UTF-8", fromCharSet);
-        static cCharSetConv converter(fromCharSet);
-        static cMutex mutex;
-        mutex.Lock();
-        text = converter.Convert(*text);
-        mutex.Unlock();
+        cCharSetConv *converter = (cCharSetConv*)g_private_get(&fromIso6937Converter);
+        if (converter == NULL) {
+           // initialized once, the threads only read it
+           static const char *fromCharSet = FromCharSet();
+           d4syslog("dbus2vdr: ToUtf8: create charset converter from %s to UTF-8", fromCharSet);
+           converter = new cCharSetConv(fromCharSet);
+           g_private_set(&fromIso6937Converter, converter);
+           }
+        text = converter->Convert(*text);
         }
      }
   else {
-     d4syslog("dbus2vdr: ToUtf8: create charset converter to UTF-8");
-     static cCharSetConv converter(NULL, "UTF-8");
-     static cMutex mutex;
-     mutex.Lock();
-     text = converter.Convert(*text);
-     mutex.Unlock();
+     cCharSetConv *converter = (cCharSetConv*)g_private_get(&toUtf8Converter);
+     if (converter == NULL) {
+        d4syslog("dbus2vdr: ToUtf8: create charset converter to UTF-8");
+        converter = new cCharSetConv(NULL, "UTF-8");
+        g_private_set(&toUtf8Converter, converter);
+        }
+     text = converter->Convert(*text);
      }
 }
 
@@ -2,6 +2,7 @@
 #define __DBUS2VDR_HELPER_H
 
 #include <gio/gio.h>
+#include <vdr/config.h>
 #include <vdr/thread.h>
 #include <vdr/tools.h>
 
@@ -13,6 +14,7 @@ private:
 
 public:
   static void SetConfigDirectory(const char *configDir) { _pluginConfigDir = configDir; };
+  static const char *ConfigDirectory(void) { return *_pluginConfigDir; };
   static bool IsValidUtf8(const char *text);
   static void ToUtf8(cString &text);
 
@@ -21,6 +23,63 @@ public:
   static void SendReply(GDBusMethodInvocation *Invocation, int  ReplyCode, const char *ReplyMessage);
 };
 
+// array of pointers to the items of a vdr list for random access in O(1)
+// it's only rebuilt if the list has changed
+template<class T> class cDBusListIndex
+{
+private:
+  cMutex            _mutex;
+  cVector<const T*> _items;
+#if VDRVERSNUM > 20300
+  cStateKey         _stateKey;
+#endif
+
+public:
+  // holds the index for Update and the following calls of Count and Get,
+  // so another thread can't rebuild it while the caller is iterating
+  class cLock
+  {
+  private:
+    cMutexLock _lock;
+  public:
+    cLock(cDBusListIndex<T> &Index) : _lock(&Index._mutex) {};
+  };
+
+  // must be called while holding a read lock on the list and a cLock on the index,
+  // returns true if the index has been rebuilt
+  bool Update(const cList<T> *List)
+  {
+#if VDRVERSNUM > 20300
+    // the caller holds a read lock, so the state can't change
+    // while it's probed with our own key
+    if (!List->Lock(_stateKey))
+       return false;
+    _stateKey.Remove();
+#else
+    // there's no state of the list, but comparing the pointers
+    // is still cheaper than clearing and refilling the array
+    if (List->Count() == _items.Size()) {
+       int i = 0;
+       const T *item = List->First();
+       while ((item != NULL) && (item == _items[i])) {
+             item = List->Next(item);
+             i++;
+             }
+       if (item == NULL)
+          return false;
+       }
+#endif
+    _items.Clear();
+    for (const T *item = List->First(); item; item = List->Next(item))
+        _items.Append(item);
+    return true;
+  };
+
+  // only valid as long as the read lock and the cLock used with Update are held
+  int      Count(void) const { return _items.Size(); };
+  const T *Get(int Index) const { return ((Index >= 0) && (Index < _items.Size())) ? _items[Index] : NULL; };
+};
+
 // copy of vdr's cPipe but returns exit code of child on Close
 class cExitPipe
 {
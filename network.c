@@ -306,9 +306,20 @@ const char *cDBusNetworkAddress::Address(void)
 
 GMainContext *cDBusNetworkClient::_context = NULL;
 cList<cDBusNetworkClient> cDBusNetworkClient::_clients;
+cMutex        cDBusNetworkClient::_clientsMutex;
 cPlugin      *cDBusNetworkClient::_avahi4vdr = NULL;
 cString       cDBusNetworkClient::_avahi_browser_id;
 
+bool  cDBusNetworkClient::IsClient(cDBusNetworkClient *Client)
+{
+  // with _clientsMutex locked
+  for (cDBusNetworkClient *c = _clients.First(); c; c = _clients.Next(c)) {
+      if (c == Client)
+         return true;
+      }
+  return false;
+}
+
 void  cDBusNetworkClient::OnConnect(cDBusConnection *Connection, gpointer UserData)
 {
   if (UserData == NULL)
@@ -320,6 +331,11 @@ void  cDBusNetworkClient::OnConnect(cDBusConnection *Connection, gpointer UserDa
      client->_signal_timer_change = new cDBusSignal(client->_busname, "/Status", DBUS_VDR_STATUS_INTERFACE, "TimerChange", NULL, OnTimerChange, UserData);
      client->_connection->Subscribe(client->_signal_timer_change);
      }
+  if (client->_signal_timer_batch_change == NULL) {
+     client->_signal_timer_batch_change = new cDBusSignal(client->_busname, "/Status", DBUS_VDR_STATUS_INTERFACE, "TimerBatchChange", NULL, OnTimerBatchChange, UserData);
+     client->_connection->Subscribe(client->_signal_timer_batch_change);
+     }
+  client->RequestTimers();
 }
 
 void  cDBusNetworkClient::OnDisconnect(cDBusConnection *Connection, gpointer UserData)
@@ -333,6 +349,12 @@ void  cDBusNetworkClient::OnDisconnect(cDBusConnection *Connection, gpointer Use
      client->_connection->Unsubscribe(client->_signal_timer_change);
      client->_signal_timer_change = NULL;
      }
+  if ((client->_signal_timer_batch_change != NULL) && (client->_connection != NULL)) {
+     client->_connection->Unsubscribe(client->_signal_timer_batch_change);
+     client->_signal_timer_batch_change = NULL;
+     }
+  cMutexLock MutexLock(&_clientsMutex);
+  g_hash_table_remove_all(client->_timers);
 }
 
 void  cDBusNetworkClient::OnTimerChange(const gchar *SenderName, const gchar *ObjectPath, const gchar *Interface, const gchar *Signal, GVariant *Parameters, gpointer UserData)
@@ -342,8 +364,26 @@ void  cDBusNetworkClient::OnTimerChange(const gchar *SenderName, const gchar *Ob
 
   cDBusNetworkClient *client = (cDBusNetworkClient*)UserData;
   d4syslog("dbus2vdr: NetworkClient: timer changed on %s", client->Name());
-  if (client->_connection != NULL)
-     client->_connection->CallMethod(new cDBusMethodCall(client->_busname, "/Timers", DBUS_VDR_TIMER_INTERFACE, "List", NULL, OnTimerList, client));
+  const char *timer = NULL;
+  const char *change = NULL;
+  g_variant_get(Parameters, "(&s&s)", &timer, &change);
+  client->ApplyTimerChange(timer, change);
+}
+
+void  cDBusNetworkClient::OnTimerBatchChange(const gchar *SenderName, const gchar *ObjectPath, const gchar *Interface, const gchar *Signal, GVariant *Parameters, gpointer UserData)
+{
+  if (UserData == NULL)
+     return;
+
+  cDBusNetworkClient *client = (cDBusNetworkClient*)UserData;
+  d4syslog("dbus2vdr: NetworkClient: timers changed on %s", client->Name());
+  GVariantIter *iter = NULL;
+  const char *timer = NULL;
+  const char *change = NULL;
+  g_variant_get(Parameters, "(a(ss))", &iter);
+  while (g_variant_iter_next(iter, "(&s&s)", &timer, &change))
+        client->ApplyTimerChange(timer, change);
+  g_variant_iter_free(iter);
 }
 
 void  cDBusNetworkClient::OnTimerList(GVariant *Reply, gpointer UserData)
@@ -351,8 +391,70 @@ void  cDBusNetworkClient::OnTimerList(GVariant *Reply, gpointer UserData)
   if (UserData == NULL)
      return;
 
+  cMutexLock MutexLock(&_clientsMutex);
   cDBusNetworkClient *client = (cDBusNetworkClient*)UserData;
+  if (!IsClient(client))
+     return;
+
   d4syslog("dbus2vdr: NetworkClient: get timer from %s", client->Name());
+  g_hash_table_remove_all(client->_timers);
+  if (Reply == NULL)
+     return;
+
+  GVariantIter *iter = NULL;
+  const char *timer = NULL;
+  g_variant_get(Reply, "(as)", &iter);
+  while (g_variant_iter_next(iter, "&s", &timer)) {
+        int count = GPOINTER_TO_INT(g_hash_table_lookup(client->_timers, timer));
+        g_hash_table_insert(client->_timers, g_strdup(timer), GINT_TO_POINTER(count + 1));
+        }
+  g_variant_iter_free(iter);
+}
+
+void  cDBusNetworkClient::RequestTimers(void)
+{
+  if (_connection != NULL)
+     _connection->CallMethod(new cDBusMethodCall(_busname, "/Timers", DBUS_VDR_TIMER_INTERFACE, "List", NULL, OnTimerList, this));
+}
+
+void  cDBusNetworkClient::ApplyTimerChange(const char *Timer, const char *Change)
+{
+  if ((Timer == NULL) || (Change == NULL))
+     return;
+
+  // a modified timer can't be matched with its old text, so fetch all timers
+  if ((*Timer == 0) || (strcmp(Change, "tcMod") == 0)) {
+     RequestTimers();
+     return;
+     }
+
+  cMutexLock MutexLock(&_clientsMutex);
+  int count = GPOINTER_TO_INT(g_hash_table_lookup(_timers, Timer));
+  if (strcmp(Change, "tcAdd") == 0)
+     g_hash_table_insert(_timers, g_strdup(Timer), GINT_TO_POINTER(count + 1));
+  else if (strcmp(Change, "tcDel") == 0) {
+     if (count > 1)
+        g_hash_table_insert(_timers, g_strdup(Timer), GINT_TO_POINTER(count - 1));
+     else if (count == 1)
+        g_hash_table_remove(_timers, Timer);
+     else
+        RequestTimers();
+     }
+}
+
+void  cDBusNetworkClient::GetRemoteTimers(GVariantBuilder *Array)
+{
+  cMutexLock MutexLock(&_clientsMutex);
+  for (cDBusNetworkClient *c = _clients.First(); c; c = _clients.Next(c)) {
+      GHashTableIter iter;
+      gpointer key;
+      gpointer value;
+      g_hash_table_iter_init(&iter, c->_timers);
+      while (g_hash_table_iter_next(&iter, &key, &value)) {
+            for (int i = 0; i < GPOINTER_TO_INT(value); i++)
+                g_variant_builder_add(Array, "(ss)", c->_name, (const char*)key);
+            }
+      }
 }
 
 cDBusNetworkClient::cDBusNetworkClient(const char *Name, const char *Host, const char *Address, int Port, const char *Busname)
@@ -363,19 +465,38 @@ cDBusNetworkClient::cDBusNetworkClient(const char *Name, const char *Host, const
   _port = Port;
   _busname = g_strdup(Busname);
   _signal_timer_change = NULL;
+  _signal_timer_batch_change = NULL;
+  _timers = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
 
   cDBusNetworkAddress address(_address, _port);
   _connection = new cDBusConnection(NULL, Name, address.Address(), _context);
   _connection->SetConnectCallbacks(OnConnect, OnDisconnect, this);
-  _connection->Connect(FALSE);
 
+  _clientsMutex.Lock();
   _clients.Add(this);
+  _clientsMutex.Unlock();
+  _connection->Connect(FALSE);
   isyslog("dbus2vdr: new network client for '%s' ['%s'] with address '%s' on port %d with busname %s", _name, _host, _address, _port, _busname);
 }
 
 cDBusNetworkClient::~cDBusNetworkClient(void)
 {
   isyslog("dbus2vdr: remove network client '%s'", _name);
+  // must not be called with _clientsMutex locked, because the callbacks
+  // on the main loop lock it while Disconnect waits for the main loop
+  if (_connection != NULL) {
+     if (_signal_timer_change != NULL) {
+        _connection->Unsubscribe(_signal_timer_change);
+        _signal_timer_change = NULL;
+        }
+     if (_signal_timer_batch_change != NULL) {
+        _connection->Unsubscribe(_signal_timer_batch_change);
+        _signal_timer_batch_change = NULL;
+        }
+     // no callback will be called after the connection is deleted
+     delete _connection;
+     _connection = NULL;
+     }
   if (_busname != NULL) {
      g_free(_busname);
      _busname = NULL;
@@ -392,6 +513,10 @@ cDBusNetworkClient::~cDBusNetworkClient(void)
      g_free(_address);
      _address = NULL;
      }
+  if (_timers != NULL) {
+     g_hash_table_destroy(_timers);
+     _timers = NULL;
+     }
 }
 
 int  cDBusNetworkClient::Compare(const cListObject &ListObject) const
@@ -426,17 +551,31 @@ void  cDBusNetworkClient::StopClients(void)
      _avahi_browser_id = NULL;
      }
 
+  // the clients are deleted without the mutex, see the destructor
+  cList<cDBusNetworkClient> clients;
+  _clientsMutex.Lock();
   cDBusNetworkClient *c;
-  while ((c = _clients.First()) != NULL)
-        _clients.Del(c, true);
+  while ((c = _clients.First()) != NULL) {
+        _clients.Del(c, false);
+        clients.Add(c);
+        }
+  _clientsMutex.Unlock();
+  clients.Clear();
 }
 
 void  cDBusNetworkClient::RemoveClient(const char *Name)
 {
+  cDBusNetworkClient *client = NULL;
+  _clientsMutex.Lock();
   for (cDBusNetworkClient *c = _clients.First(); c; c = _clients.Next(c)) {
       if (g_strcmp0(c->Name(), Name) == 0) {
-         _clients.Del(c, true);
+         _clients.Del(c, false);
+         client = c;
          break;
          }
       }
+  _clientsMutex.Unlock();
+  // see the destructor
+  if (client != NULL)
+     delete client;
 }
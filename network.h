@@ -68,10 +68,13 @@ private:
   static void  OnConnect(cDBusConnection *Connection, gpointer UserData);
   static void  OnDisconnect(cDBusConnection *Connection, gpointer UserData);
   static void  OnTimerChange(const gchar *SenderName, const gchar *ObjectPath, const gchar *Interface, const gchar *Signal, GVariant *Parameters, gpointer UserData);
+  static void  OnTimerBatchChange(const gchar *SenderName, const gchar *ObjectPath, const gchar *Interface, const gchar *Signal, GVariant *Parameters, gpointer UserData);
   static void  OnTimerList(GVariant *Reply, gpointer UserData);
+  static bool  IsClient(cDBusNetworkClient *Client);
 
   static GMainContext *_context;
   static cList<cDBusNetworkClient> _clients;
+  static cMutex        _clientsMutex;
   static cPlugin      *_avahi4vdr;
   static cString       _avahi_browser_id;
 
@@ -83,6 +86,13 @@ private:
 
   cDBusConnection *_connection;
   cDBusSignal     *_signal_timer_change;
+  cDBusSignal     *_signal_timer_batch_change;
+
+  // mirror of the remote timers, text like timer.List -> count
+  GHashTable      *_timers;
+
+  void  RequestTimers(void);
+  void  ApplyTimerChange(const char *Timer, const char *Change);
 
 public:
   cDBusNetworkClient(const char *Name, const char *Host, const char *Address, int Port, const char *Busname);
@@ -100,6 +110,8 @@ public:
   static void  StopClients(void);
   static const char *AvahiBrowserId(void) { return *_avahi_browser_id; }
   static void  RemoveClient(const char *Name);
+  // adds the mirrored timers of all clients as (name, timer) to an "a(ss)" array
+  static void  GetRemoteTimers(GVariantBuilder *Array);
 };
 
 #endif
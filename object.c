@@ -3,6 +3,17 @@
 #include "connection.h"
 
 
+#define DBUS_METHOD_BUCKETS 32 // bucket n counts the latencies below 2^(n+1) us
+
+struct tDBusMethodStat {
+  char *path;
+  char *method;
+  bool  isInline;
+  gint  calls;
+  gint  buckets[DBUS_METHOD_BUCKETS];
+};
+
+
 const GDBusInterfaceVTable cDBusObject::_interface_vtable =
 {
   cDBusObject::handle_method_call,
@@ -16,16 +27,24 @@ public:
   static GThreadPool *_thread_pool;
   
   cDBusObject *_object;
+  cDBusMethod *_method;
   GDBusMethodInvocation *_invocation;
+  gint64 _start;
   
-  cWorkerData(cDBusObject *Object, GDBusMethodInvocation *Invocation)
+  cWorkerData(cDBusObject *Object, cDBusMethod *Method, GDBusMethodInvocation *Invocation, gint64 Start)
   {
     _object = Object;
+    _method = Method;
     _invocation = Invocation;
+    _start = Start;
   };
 };
 
 GThreadPool *cWorkerData::_thread_pool = NULL;
+cMutex       cDBusObject::_statMutex;
+GHashTable  *cDBusObject::_stats = NULL;
+cMutex       cDBusObject::_objectsMutex;
+cVector<cDBusObject*> cDBusObject::_objects;
 
 void  cDBusObject::FreeThreadPool(void)
 {
@@ -42,24 +61,94 @@ void  cDBusObject::do_work(gpointer data, gpointer user_data)
      return;
 
   cWorkerData *workerData = (cWorkerData*)data;
-  const gchar *method_name = g_dbus_method_invocation_get_method_name(workerData->_invocation);
-  d4syslog("dbus2vdr: do_work on %s.%s", workerData->_object->Path(), method_name);
-  bool err = true;
-  for (cDBusMethod *m = workerData->_object->_methods.First(); m; m = workerData->_object->_methods.Next(m)) {
-      if (g_strcmp0(m->_name, method_name) == 0) {
-         m->_method(workerData->_object, g_dbus_method_invocation_get_parameters(workerData->_invocation), workerData->_invocation);
-         err = false;
-         break;
-         }
+  d4syslog("dbus2vdr: do_work on %s.%s", workerData->_object->Path(), g_dbus_method_invocation_get_method_name(workerData->_invocation));
+  workerData->_object->CallMethod(workerData->_method, workerData->_invocation, workerData->_start);
+  delete workerData;
+}
+
+cDBusMethod *cDBusObject::FindMethod(const char *Name)
+{
+  for (cDBusMethod *m = _methods.First(); m; m = _methods.Next(m)) {
+      if (g_strcmp0(m->_name, Name) == 0)
+         return m;
       }
-  if (err) {
-     g_dbus_method_invocation_return_error(workerData->_invocation, G_IO_ERROR, G_IO_ERROR_FAILED_HANDLED,
+  return NULL;
+}
+
+void  cDBusObject::CallMethod(cDBusMethod *Method, GDBusMethodInvocation *Invocation, gint64 Start)
+{
+  if (Method == NULL) {
+     g_dbus_method_invocation_return_error(Invocation, G_IO_ERROR, G_IO_ERROR_FAILED_HANDLED,
                                            "method '%s.%s' on object '%s' is not implemented yet",
-                                           g_dbus_method_invocation_get_interface_name(workerData->_invocation),
-                                           g_dbus_method_invocation_get_method_name(workerData->_invocation),
-                                           g_dbus_method_invocation_get_object_path(workerData->_invocation));
+                                           g_dbus_method_invocation_get_interface_name(Invocation),
+                                           g_dbus_method_invocation_get_method_name(Invocation),
+                                           g_dbus_method_invocation_get_object_path(Invocation));
+     return;
      }
-  delete workerData;
+
+  Method->_method(this, g_dbus_method_invocation_get_parameters(Invocation), Invocation);
+
+  // the latency includes the time waiting for a thread of the pool
+  gint64 latency = g_get_monotonic_time() - Start;
+  int bucket = 0;
+  while ((bucket < DBUS_METHOD_BUCKETS - 1) && (latency >= ((gint64)2 << bucket)))
+        bucket++;
+  g_atomic_int_inc(&Method->_stat->buckets[bucket]);
+  g_atomic_int_inc(&Method->_stat->calls);
+}
+
+tDBusMethodStat *cDBusObject::MethodStat(const char *Path, const cDBusMethod *Method)
+{
+  cMutexLock MutexLock(&_statMutex);
+  if (_stats == NULL)
+     _stats = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  char *key = g_strdup_printf("%s %s", Path, Method->_name);
+  tDBusMethodStat *stat = (tDBusMethodStat*)g_hash_table_lookup(_stats, key);
+  if (stat != NULL) {
+     g_free(key);
+     return stat;
+     }
+  // kept until vdr exits, since the methods keep a pointer to it
+  stat = g_new0(tDBusMethodStat, 1);
+  stat->path = g_strdup(Path);
+  stat->method = g_strdup(Method->_name);
+  stat->isInline = Method->_inline;
+  g_hash_table_insert(_stats, key, stat);
+  return stat;
+}
+
+void  cDBusObject::GetMethodStatistics(GVariantBuilder *Array)
+{
+  cMutexLock MutexLock(&_statMutex);
+  if (_stats == NULL)
+     return;
+
+  const int percents[] = { 50, 90, 99 };
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, _stats);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        tDBusMethodStat *stat = (tDBusMethodStat*)value;
+        gint buckets[DBUS_METHOD_BUCKETS];
+        guint64 calls = 0;
+        for (int i = 0; i < DBUS_METHOD_BUCKETS; i++) {
+            buckets[i] = g_atomic_int_get(&stat->buckets[i]);
+            calls += buckets[i];
+            }
+        // the upper limit of the bucket containing the percentile
+        guint32 p[3] = { 0, 0, 0 };
+        for (int n = 0; n < 3; n++) {
+            guint64 sum = 0;
+            for (int i = 0; i < DBUS_METHOD_BUCKETS; i++) {
+                sum += buckets[i];
+                if ((calls > 0) && (sum * 100 >= calls * percents[n])) {
+                   p[n] = (guint32)((guint64)2 << i);
+                   break;
+                   }
+                }
+            }
+        g_variant_builder_add(Array, "(ssbuuuu)", stat->path, stat->method, stat->isInline, (guint32)calls, p[0], p[1], p[2]);
+        }
 }
 
 void  cDBusObject::handle_method_call(GDBusConnection *connection, const gchar *sender, const gchar *object_path, const gchar *interface_name, const gchar *method_name, GVariant *parameters, GDBusMethodInvocation *invocation, gpointer user_data)
@@ -68,7 +157,16 @@ void  cDBusObject::handle_method_call(GDBusConnection *connection, const gchar *
      return;
 
   d4syslog("dbus2vdr: handle_method_call: sender '%s', object '%s', interface '%s', method '%s'", sender, object_path, interface_name, method_name);
-  cWorkerData *workerData = new cWorkerData((cDBusObject*)user_data, invocation);
+  gint64 start = g_get_monotonic_time();
+  cDBusObject *object = (cDBusObject*)user_data;
+  cDBusMethod *method = object->FindMethod(method_name);
+  // cheap methods like hitting a key shouldn't wait behind slow ones in the pool
+  if ((method != NULL) && method->_inline) {
+     object->CallMethod(method, invocation, start);
+     return;
+     }
+
+  cWorkerData *workerData = new cWorkerData(object, method, invocation, start);
   if (cWorkerData::_thread_pool == NULL) {
      GError *err = NULL;
      cWorkerData::_thread_pool = g_thread_pool_new(do_work, NULL, 10, FALSE, &err);
@@ -98,10 +196,25 @@ cDBusObject::cDBusObject(const char *Path, const char *XmlNodeInfo)
      esyslog("dbus2vdr: g_dbus_node_info_new_for_xml reports: %s", err->message);
      g_error_free(err);
      }
+
+  _objectsMutex.Lock();
+  _objects.Append(this);
+  _objectsMutex.Unlock();
 }
 
 cDBusObject::~cDBusObject(void)
 {
+  _objectsMutex.Lock();
+  int i = 0;
+  while (i < _objects.Size()) {
+        if (_objects[i] == this) {
+           _objects.Remove(i);
+           break;
+           }
+        i++;
+        }
+  _objectsMutex.Unlock();
+
   if (_introspection_data != NULL) {
      g_dbus_node_info_unref(_introspection_data);
      _introspection_data = NULL;
@@ -124,6 +237,11 @@ void  cDBusObject::Register(void)
 
   if (_registration_ids != NULL)
      Unregister();
+  // the stats are created before the first call can arrive and are never changed later
+  for (cDBusMethod *m = _methods.First(); m; m = _methods.Next(m)) {
+      if (m->_stat == NULL)
+         m->_stat = MethodStat(Path(), m);
+      }
   int len = 0;
   while (_introspection_data->interfaces[len] != NULL)
         len++;
@@ -154,8 +272,23 @@ void  cDBusObject::Unregister(void)
      }
 }
 
+void  cDBusObject::EmitSignal(const char *Path, const char *Interface, const char *Signal, GVariant *Parameters)
+{
+  g_variant_ref_sink(Parameters);
+  _objectsMutex.Lock();
+  for (int i = 0; i < _objects.Size(); i++) {
+      cDBusObject *o = _objects[i];
+      if ((o->_connection != NULL) && (g_strcmp0(o->_path, Path) == 0))
+         o->_connection->EmitSignal(new cDBusSignal(NULL, Path, Interface, Signal, Parameters, NULL, NULL));
+      }
+  _objectsMutex.Unlock();
+  g_variant_unref(Parameters);
+}
+
 void  cDBusObject::SetPath(const char *Path)
 {
+  // EmitSignal compares the path
+  cMutexLock MutexLock(&_objectsMutex);
   if (_path != NULL) {
      g_free(_path);
      _path = NULL;
@@ -163,8 +296,8 @@ void  cDBusObject::SetPath(const char *Path)
   _path = g_strdup(Path);
 }
 
-void  cDBusObject::AddMethod(const char *Name, cDBusMethodFunc Method)
+void  cDBusObject::AddMethod(const char *Name, cDBusMethodFunc Method, bool Inline)
 {
   if ((Name != NULL) && (Method != NULL))
-     _methods.Add(new cDBusMethod(Name, Method));
+     _methods.Add(new cDBusMethod(Name, Method, Inline));
 }
@@ -9,6 +9,7 @@
 
 class cDBusConnection;
 class cDBusObject;
+struct tDBusMethodStat;
 
 typedef void (*cDBusMethodFunc)(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation);
 
@@ -19,9 +20,11 @@ private:
 
   const char *_name;
   cDBusMethodFunc _method;
+  bool _inline;            // called by the thread of the main loop instead of the thread-pool
+  tDBusMethodStat *_stat;  // shared by all objects with the same path, set by Register
 
-  cDBusMethod(const char *Name, cDBusMethodFunc Method)
-   :_name(Name),_method(Method)
+  cDBusMethod(const char *Name, cDBusMethodFunc Method, bool Inline)
+   :_name(Name),_method(Method),_inline(Inline),_stat(NULL)
   {
   };
 };
@@ -31,6 +34,12 @@ class cDBusObject : public cListObject
 private:
   friend class cDBusConnection;
 
+  static cMutex      _statMutex;
+  static GHashTable *_stats; // "path method" -> tDBusMethodStat
+  static cMutex                _objectsMutex;
+  static cVector<cDBusObject*> _objects; // all objects of all connections, see EmitSignal
+
+  static tDBusMethodStat *MethodStat(const char *Path, const cDBusMethod *Method);
   static void  do_work(gpointer data, gpointer user_data);
   static void  handle_method_call(GDBusConnection       *connection,
                                   const gchar           *sender,
@@ -52,13 +61,23 @@ private:
   void  SetConnection(cDBusConnection *Connection) { _connection = Connection; };
   void  Register(void);
   void  Unregister(void);
+  cDBusMethod *FindMethod(const char *Name);
+  // Start is the arrival of the call in the main loop
+  void  CallMethod(cDBusMethod *Method, GDBusMethodInvocation *Invocation, gint64 Start);
 
 protected:
   void  SetPath(const char *Path);
-  void  AddMethod(const char *Name, cDBusMethodFunc Method);
+  // inline methods must be cheap and must not block, since no other
+  // method-call is dispatched while they are running
+  void  AddMethod(const char *Name, cDBusMethodFunc Method, bool Inline = false);
 
 public:
   static void  FreeThreadPool(void);
+  // adds the latencies of all called methods to an "a(ssbuuuu)" array
+  static void  GetMethodStatistics(GVariantBuilder *Array);
+  // emits the signal on every connection with an object of the given path,
+  // a floating reference of Parameters is taken
+  static void  EmitSignal(const char *Path, const char *Interface, const char *Signal, GVariant *Parameters);
 
   cDBusObject(const char *Path, const char *XmlNodeInfo);
   virtual ~cDBusObject(void);
@@ -3,19 +3,35 @@
 #include "common.h"
 #include "connection.h"
 #include "helper.h"
+#include "osdencoder.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/time.h>
-
-#ifndef NO_PNGPP
-#include <png++/image.hpp>
-#include <png++/rgba_pixel.hpp>
-#endif
+#include <gio/gunixfdlist.h>
 
 #include <vdr/device.h>
 #include <vdr/videodir.h>
 
-#define DBUSOSDDIR "/tmp/dbus2vdr"
-//#define DBUSOSDDIR VideoDirectory
+#define DBUSOSDDIR "/tmp/dbus2vdr" // default, see --osd-dir
+
+#define DBUSOSD_ENCODER_THREADS 2  // max. number of pixmaps encoded in parallel
+#define DBUSOSD_TILESIZE        16 // changes are detected in tiles of 16x16 pixels
+#define DBUSOSD_MAXRECTS        16 // max. number of changed parts per pixmap
+#define DBUSOSD_KEEPFILES       16 // default number of files per osd, see --osd-keep
+
+typedef struct {
+  cDbusOsdMsg *msg;
+  uchar       *data;  // BGRA
+  int          width;
+  int          height;
+} tDBusOsdEncodeJob;
+
+typedef struct {
+  int   refs;     // number of handles
+  char *filename;
+} tDBusOsdImage;
 
 
 int   cDBusOsd::osd_number = 0;
@@ -25,24 +41,172 @@ cDBusOsd::cDBusOsd(cDBusOsdProvider& Provider, int Left, int Top, uint Level)
  ,provider(Provider)
  ,osd_index(osd_number++)
  ,counter(0)
+ ,fb_fd(-1)
+ ,fb_data(NULL)
+ ,fb_width(0)
+ ,fb_height(0)
 {
-  osd_dir = cString::sprintf("%s/dbusosd-%04x", DBUSOSDDIR, osd_index);
-  if (!MakeDirs(*osd_dir, true))
+  osd_dir = cString::sprintf("%s/dbusosd-%04x", cDBusOsdProvider::Directory(), osd_index);
+  if ((provider.Mode() != cDBusOsdProvider::modeShm) && !MakeDirs(*osd_dir, true))
      esyslog("dbus2vdr: can't create %s", *osd_dir);
-  provider.SendMessage(new cDbusOsdMsg("Open", osd_dir, Left, Top, 0, 0));
+  CreateFramebuffer();
+  provider.AddOsd(this);
+  provider.SendMessage(new cDbusOsdMsg("Open", osd_index, osd_dir, Left, Top, 0, 0));
 }
 
 cDBusOsd::~cDBusOsd()
 {
-  provider.SendMessage(new cDbusOsdMsg("Close", osd_dir, 0, 0, 0, 0));
+  provider.DelOsd(this);
+  provider.SendMessage(new cDbusOsdMsg("Close", osd_index, osd_dir, 0, 0, 0, 0));
+  // clients which have mapped the framebuffer keep their mapping
+  if (fb_fd >= 0) {
+     munmap(fb_data, fb_width * fb_height * sizeof(tColor));
+     close(fb_fd);
+     }
+  else
+     free(fb_data);
+}
+
+void cDBusOsd::CreateFramebuffer(void)
+{
+  // big enough for every osd inside the configured osd area
+  int width = cOsd::OsdLeft() + cOsd::OsdWidth();
+  int height = cOsd::OsdTop() + cOsd::OsdHeight();
+  size_t size = width * height * sizeof(tColor);
+
+  if (provider.Mode() != cDBusOsdProvider::modeShm) {
+     // holds the last written content to find the changed parts
+     if (provider.Encoder() != NULL)
+        fb_data = (tColor*)calloc(width * height, sizeof(tColor));
+     if (fb_data != NULL) {
+        fb_width = width;
+        fb_height = height;
+        }
+     return;
+     }
+
+  int fd = memfd_create(*osd_dir, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+     esyslog("dbus2vdr: can't create framebuffer for %s: %s", *osd_dir, strerror(errno));
+     return;
+     }
+  if (ftruncate(fd, size) != 0) {
+     esyslog("dbus2vdr: can't resize framebuffer for %s: %s", *osd_dir, strerror(errno));
+     close(fd);
+     return;
+     }
+  // clients may rely on the size of the mapping
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+  void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+     esyslog("dbus2vdr: can't map framebuffer for %s: %s", *osd_dir, strerror(errno));
+     close(fd);
+     return;
+     }
+  fb_fd = fd;
+  fb_data = (tColor*)data;
+  fb_width = width;
+  fb_height = height;
+  d4syslog("dbus2vdr: created framebuffer %dx%d for %s", width, height, *osd_dir);
+}
+
+void cDBusOsd::DiffTiles(const tColor *Src, int SrcX, int SrcY, int SrcWidth, int X1, int Y1, int X2, int Y2, cVector<cRect> &Rects)
+{
+  // the tiles are aligned to the framebuffer, a row of a tile is compared with one memcmp
+  for (int ty = Y1 / DBUSOSD_TILESIZE; ty * DBUSOSD_TILESIZE < Y2; ty++) {
+      int ry1 = max(ty * DBUSOSD_TILESIZE, Y1);
+      int ry2 = min((ty + 1) * DBUSOSD_TILESIZE, Y2);
+      int runX1 = -1;
+      int runX2 = -1;
+      for (int tx = X1 / DBUSOSD_TILESIZE; ; tx++) {
+          int rx1 = max(tx * DBUSOSD_TILESIZE, X1);
+          int rx2 = min((tx + 1) * DBUSOSD_TILESIZE, X2);
+          bool changed = false;
+          if (rx1 < X2) {
+             size_t len = (rx2 - rx1) * sizeof(tColor);
+             for (int row = ry1; row < ry2; row++) {
+                 tColor *dst = fb_data + row * fb_width + rx1;
+                 const tColor *src = Src + (row - SrcY) * SrcWidth + (rx1 - SrcX);
+                 if (!changed && (memcmp(dst, src, len) == 0))
+                    continue;
+                 changed = true;
+                 memcpy(dst, src, len);
+                 }
+             }
+          if (changed) {
+             if (runX1 < 0)
+                runX1 = rx1;
+             runX2 = rx2;
+             continue;
+             }
+          if (runX1 >= 0) {
+             // extend a rectangle of the previous tile row with the same columns
+             bool merged = false;
+             for (int i = Rects.Size() - 1; !merged && (i >= 0); i--) {
+                 cRect &r = Rects[i];
+                 if ((r.X() == runX1) && (r.Width() == runX2 - runX1) && (r.Y() + r.Height() == ry1)) {
+                    r.SetHeight(ry2 - r.Y());
+                    merged = true;
+                    }
+                 }
+             if (!merged)
+                Rects.Append(cRect(runX1, ry1, runX2 - runX1, ry2 - ry1));
+             runX1 = -1;
+             }
+          if (rx1 >= X2)
+             break;
+          }
+      }
+}
+
+void cDBusOsd::SendRect(const cRect &Rect)
+{
+  if (fb_fd >= 0)
+     provider.SendMessage(new cDbusOsdMsg("DisplayRect", osd_index, osd_dir, counter, Rect.X(), Rect.Y(), Rect.Width(), Rect.Height()));
+  else {
+     // encoding is done by the provider, only a snapshot of the pixels is taken here
+     int w = Rect.Width();
+     int h = Rect.Height();
+     tColor *data = MALLOC(tColor, w * h);
+     for (int row = 0; row < h; row++)
+         memcpy(data + row * w, fb_data + (Rect.Y() + row) * fb_width + Rect.X(), w * sizeof(tColor));
+     int vx = Rect.X() - Left();
+     int vy = Rect.Y() - Top();
+     // if all files of the ring buffer of this viewport are still queued, a unique file is written
+     cString filename = provider.AcquireRingFile(*osd_dir, counter, cRect(vx, vy, w, h));
+     bool ringFile = (*filename != NULL);
+     if (!ringFile)
+        filename = cString::sprintf("%s/%04x-%d-%d-%d-%d.%s", *osd_dir, counter, Left(), Top(), vx, vy, provider.Encoder()->Extension());
+     cDbusOsdMsg *msg = new cDbusOsdMsg("Display", osd_index, filename, Left(), Top(), vx, vy);
+     msg->ringFile = ringFile;
+     provider.SendEncoded(msg, (uchar*)data, w, h);
+     }
+  counter++;
+}
+
+#if APIVERSNUM >= 20000
+void cDBusOsd::DrawImage(const cPoint &Point, int ImageHandle)
+{
+  // the image is still drawn into the pixmaps, clients may use the stored file instead
+  cOsd::DrawImage(Point, ImageHandle);
+  cString asset = provider.ImageAsset(ImageHandle);
+  if (*asset != NULL) {
+     cDbusOsdMsg *msg = new cDbusOsdMsg("DrawImage", osd_index, osd_dir, 0, 0, Point.X(), Point.Y());
+     msg->asset = asset;
+     provider.SendMessage(msg);
+     }
 }
+#endif
 
 void cDBusOsd::Flush(void)
 {
   if (!cOsd::Active())
       return;
 
-#ifndef NO_PNGPP
+#if VDRVERSNUM >= 10717
+  // there's no framebuffer without an encoder
+  if (!IsTrueColor() || (fb_data == NULL))
+     return;
 
 /*
   struct timeval start;
@@ -52,45 +216,37 @@ void cDBusOsd::Flush(void)
   bool write = false;
 */
 
-#if VDRVERSNUM >= 10717
-  if (IsTrueColor()) {
-    LOCK_PIXMAPS;
-    int left = Left();
-    int top = Top();
-    const cRect* vp;
-    int vx, vy, vw, vh;
-    int x, y;
-    const uint8_t *pixel;
-    png::image<png::rgba_pixel> *pngfile;
-    while (cPixmapMemory *pm = dynamic_cast<cPixmapMemory*>(RenderPixmaps())) {
-          /*write = true;*/
-          vp = &pm->ViewPort();
-          vx = vp->X();
-          vy = vp->Y();
-          vw = vp->Width();
-          vh = vp->Height();
-          pixel = pm->Data();
-          pngfile = new png::image<png::rgba_pixel>(vw, vh);
-          for (y = 0; y < vh ; y++) {
-              for (x = 0; x < vw; x++) {
-                  (*pngfile)[y][x] = png::rgba_pixel(pixel[2], pixel[1], pixel[0], pixel[3]);
-                  pixel += 4;
-                  }
-              }
-          cString filename = cString::sprintf("%s/%04x-%d-%d-%d-%d.png", *osd_dir, counter, left, top, vx, vy);
-          pngfile->write(*filename);
-          provider.SendMessage(new cDbusOsdMsg("Display", filename, left, top, vx, vy));
-
-          counter++;
-          delete pngfile;
+  LOCK_PIXMAPS;
+  cVector<cRect> rects;
+  while (cPixmapMemory *pm = dynamic_cast<cPixmapMemory*>(RenderPixmaps())) {
+        /*write = true;*/
+        const cRect &vp = pm->ViewPort();
+        int x = Left() + vp.X();
+        int y = Top() + vp.Y();
+        // clip to the framebuffer
+        int x1 = max(x, 0);
+        int y1 = max(y, 0);
+        int x2 = min(x + vp.Width(), fb_width);
+        int y2 = min(y + vp.Height(), fb_height);
+        if ((x1 < x2) && (y1 < y2))
+           DiffTiles((const tColor*)pm->Data(), x, y, vp.Width(), x1, y1, x2, y2, rects);
+        if (rects.Size() > DBUSOSD_MAXRECTS) {
+           // too fragmented, send the bounding box
+           cRect bounds = rects[0];
+           for (int i = 1; i < rects.Size(); i++)
+               bounds.Combine(rects[i]);
+           rects.Clear();
+           rects.Append(bounds);
+           }
+        for (int i = 0; i < rects.Size(); i++)
+            SendRect(rects[i]);
+        rects.Clear();
 #if APIVERSNUM >= 20110
-          DestroyPixmap(pm);
+        DestroyPixmap(pm);
 #else
-          delete pm;
-#endif
-          }
-  }
+        delete pm;
 #endif
+        }
 /*
   if (write) {
      gettimeofday(&end, &timeZone);
@@ -104,12 +260,41 @@ void cDBusOsd::Flush(void)
 
 
 cDBusOsdProvider *cDBusOsdProvider::_provider = NULL;
+cDBusOsdProvider::eMode cDBusOsdProvider::_defaultMode = cDBusOsdProvider::modeFiles;
+cString                 cDBusOsdProvider::_defaultEncoder;
+int                     cDBusOsdProvider::_maxFps = 0;
+int                     cDBusOsdProvider::_keepFiles = DBUSOSD_KEEPFILES;
+cString                 cDBusOsdProvider::_directory = DBUSOSDDIR;
 
 cDBusOsdProvider::cDBusOsdProvider(cDBusObject *Object)
 {
   _provider = this;
   _object = Object;
-  isyslog("dbus2vdr: new DBus-OSD-provider");
+  _mode = _defaultMode;
+  _encoder = NULL;
+  msgStop = false;
+  nextFrames = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+  busyFiles = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  statFrames = 0;
+  statDropped = 0;
+  statLatency = 0;
+  statMaxLatency = 0;
+  imageDir = cString::sprintf("%s/images", *_directory);
+  imageHandles = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+  imageAssets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, FreeImage);
+  imageCounter = 0;
+  if (_mode == modeFiles) {
+     _encoder = cDBusOsdEncoder::Create(*_defaultEncoder);
+     if (_encoder == NULL)
+        esyslog("dbus2vdr: osd encoder %s is not available", *_defaultEncoder ? *_defaultEncoder : "png");
+     }
+  GError *err = NULL;
+  encoderPool = g_thread_pool_new(EncodeJob, this, DBUSOSD_ENCODER_THREADS, FALSE, &err);
+  if (encoderPool == NULL) {
+     esyslog("dbus2vdr: can't create osd encoder pool: %s", err->message);
+     g_error_free(err);
+     }
+  isyslog("dbus2vdr: new DBus-OSD-provider (%s)", (_mode == modeShm) ? "shm" : (_encoder ? _encoder->Format() : "no encoder"));
   SetDescription("dbus2vdr: osd-provider signal");
   Start();
 }
@@ -118,8 +303,20 @@ cDBusOsdProvider::~cDBusOsdProvider()
 {
   _provider = NULL;
   isyslog("dbus2vdr: delete DBus-OSD-provider");
+  // all queued messages must be ready before the signal thread can finish
+  if (encoderPool != NULL)
+     g_thread_pool_free(encoderPool, FALSE, TRUE);
+  msgMutex.Lock();
+  msgStop = true;
   msgCond.Broadcast();
+  msgMutex.Unlock();
   Cancel(10);
+  delete _encoder;
+  g_hash_table_destroy(nextFrames);
+  g_hash_table_destroy(busyFiles);
+  g_hash_table_destroy(imageHandles);
+  g_hash_table_destroy(imageAssets);
+  RemoveFileOrDir(*imageDir, false);
 }
 
 cOsd *cDBusOsdProvider::CreateOsd(int Left, int Top, uint Level)
@@ -127,63 +324,394 @@ cOsd *cDBusOsdProvider::CreateOsd(int Left, int Top, uint Level)
   return new cDBusOsd(*this, Left, Top, Level);
 }
 
+cDbusOsdMsg *cDBusOsdProvider::NextMessage(int &Wait)
+{
+  // the messages of an osd keep their order, but a waiting frame or a file which
+  // isn't written yet doesn't hold back the other osds, the stored images (osd -1)
+  // are only kept in order with the "DrawImage" messages which refer to them
+  uint64_t now = cTimeMs::Now();
+  cVector<int> blocked;
+  for (cDbusOsdMsg *msg = msgQueue.First(); msg; msg = msgQueue.Next(msg)) {
+      bool drawImage = (strcmp(msg->action, "DrawImage") == 0);
+      if ((blocked.IndexOf(msg->osd) >= 0) || (drawImage && (blocked.IndexOf(-1) >= 0))) {
+         blocked.AppendUnique(msg->osd);
+         continue;
+         }
+      if (!msg->ready) {
+         blocked.Append(msg->osd);
+         continue;
+         }
+
+      if (msg->dropped) {
+         statDropped++;
+         msgQueue.Del(msg, false);
+         return msg;
+         }
+
+      if (msg->IsFrame()) {
+         guint64 *next = (guint64*)g_hash_table_lookup(nextFrames, GINT_TO_POINTER(msg->osd));
+         if ((_maxFps > 0) && (next != NULL) && (now < *next) && !msgStop) {
+            // only frames wait, a following message of another kind
+            // (like "Close") of the same osd takes the frame with it
+            bool flush = false;
+            for (cDbusOsdMsg *m = msgQueue.Next(msg); m && !flush; m = msgQueue.Next(m))
+                flush = ((m->osd == msg->osd) && !m->IsFrame());
+            if (!flush) {
+               // newer frames may drop this one while waiting
+               int wait = *next - now;
+               if ((Wait <= 0) || (wait < Wait))
+                  Wait = wait;
+               blocked.Append(msg->osd);
+               continue;
+               }
+            }
+         if (next == NULL) {
+            next = g_new0(guint64, 1);
+            g_hash_table_insert(nextFrames, GINT_TO_POINTER(msg->osd), next);
+            }
+         *next = now + ((_maxFps > 0) ? 1000 / _maxFps : 0);
+         guint32 latency = now - msg->queued;
+         statFrames++;
+         statLatency += latency;
+         if (latency > statMaxLatency)
+            statMaxLatency = latency;
+         }
+      else if (strcmp(msg->action, "Close") == 0)
+         g_hash_table_remove(nextFrames, GINT_TO_POINTER(msg->osd));
+      msgQueue.Del(msg, false);
+      return msg;
+      }
+  return NULL;
+}
+
 void cDBusOsdProvider::Action(void)
 {
-  while (Running() || (msgQueue.Count() > 0)) {
-        cDbusOsdMsg *dbmsg = NULL;
+  cList<cDbusOsdMsg> batch;
+  while (true) {
         { // for short lock
           cMutexLock MutexLock(&msgMutex);
-          dbmsg = msgQueue.First();
-          if (dbmsg != NULL)
-             msgQueue.Del(dbmsg, false);
+          // take all messages which are due with one lock
+          int wait = 0;
+          while (cDbusOsdMsg *msg = NextMessage(wait))
+                batch.Add(msg);
+          if (batch.Count() == 0) {
+             if (msgStop && (msgQueue.Count() == 0))
+                break;
+             // woken up by new messages or finished encoder jobs
+             if (wait > 0)
+                msgCond.TimedWait(msgMutex, wait);
+             else
+                msgCond.Wait(msgMutex);
+             continue;
+             }
         }
-        if (dbmsg != NULL) {
-           GVariantBuilder *builder = NULL;
-           if (strcmp(dbmsg->action, "Open") == 0) {
-              builder = g_variant_builder_new(G_VARIANT_TYPE("(sii)"));
-              g_variant_builder_add(builder, "s", *dbmsg->file);
-              g_variant_builder_add(builder, "i", dbmsg->left);
-              g_variant_builder_add(builder, "i", dbmsg->top);
-              }
-           else if (strcmp(dbmsg->action, "Display") == 0) {
-              builder = g_variant_builder_new(G_VARIANT_TYPE("(siiii)"));
-              g_variant_builder_add(builder, "s", *dbmsg->file);
-              g_variant_builder_add(builder, "i", dbmsg->left);
-              g_variant_builder_add(builder, "i", dbmsg->top);
-              g_variant_builder_add(builder, "i", dbmsg->vx);
-              g_variant_builder_add(builder, "i", dbmsg->vy);
-              }
-           else if (strcmp(dbmsg->action, "Close") == 0) {
-              builder = g_variant_builder_new(G_VARIANT_TYPE("(s)"));
-              g_variant_builder_add(builder, "s", *dbmsg->file);
-              }
 
-           if ((builder != NULL) && (_object != NULL)) {
-              _object->Connection()->EmitSignal(new cDBusSignal(NULL, "/OSD", DBUS_VDR_OSD_INTERFACE, dbmsg->action, g_variant_builder_end(builder), NULL, NULL));
-              g_variant_builder_unref(builder);
-              }
-           delete dbmsg;
-           }
-        cMutexLock MutexLock(&msgMutex);
-        if (msgQueue.Count() == 0)
-           msgCond.TimedWait(msgMutex, 1000);
+        cList<cDBusSignal> signals;
+        for (cDbusOsdMsg *dbmsg = batch.First(); dbmsg; dbmsg = batch.Next(dbmsg)) {
+            if (dbmsg->dropped) {
+               // a file of the ring buffer may still hold an older image
+               // which has been signaled, a unique file is never read
+               if ((strcmp(dbmsg->action, "Display") == 0) && !dbmsg->ringFile)
+                  unlink(*dbmsg->file);
+               continue;
+               }
+
+            GVariantBuilder *builder = NULL;
+            if (strcmp(dbmsg->action, "Open") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(sii)"));
+               g_variant_builder_add(builder, "s", *dbmsg->file);
+               g_variant_builder_add(builder, "i", dbmsg->left);
+               g_variant_builder_add(builder, "i", dbmsg->top);
+               }
+            else if (strcmp(dbmsg->action, "Display") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(siiiis)"));
+               g_variant_builder_add(builder, "s", *dbmsg->file);
+               g_variant_builder_add(builder, "i", dbmsg->left);
+               g_variant_builder_add(builder, "i", dbmsg->top);
+               g_variant_builder_add(builder, "i", dbmsg->vx);
+               g_variant_builder_add(builder, "i", dbmsg->vy);
+               g_variant_builder_add(builder, "s", _encoder->Format());
+               }
+            else if (strcmp(dbmsg->action, "DisplayRect") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(suiiii)"));
+               g_variant_builder_add(builder, "s", *dbmsg->file);
+               g_variant_builder_add(builder, "u", dbmsg->seq);
+               g_variant_builder_add(builder, "i", dbmsg->vx);
+               g_variant_builder_add(builder, "i", dbmsg->vy);
+               g_variant_builder_add(builder, "i", dbmsg->width);
+               g_variant_builder_add(builder, "i", dbmsg->height);
+               }
+            else if (strcmp(dbmsg->action, "Close") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(s)"));
+               g_variant_builder_add(builder, "s", *dbmsg->file);
+               }
+            else if (strcmp(dbmsg->action, "ImageStored") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(ssiis)"));
+               g_variant_builder_add(builder, "s", *dbmsg->asset);
+               g_variant_builder_add(builder, "s", *dbmsg->file);
+               g_variant_builder_add(builder, "i", dbmsg->width);
+               g_variant_builder_add(builder, "i", dbmsg->height);
+               g_variant_builder_add(builder, "s", _encoder->Format());
+               }
+            else if (strcmp(dbmsg->action, "ImageDropped") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(s)"));
+               g_variant_builder_add(builder, "s", *dbmsg->asset);
+               }
+            else if (strcmp(dbmsg->action, "DrawImage") == 0) {
+               builder = g_variant_builder_new(G_VARIANT_TYPE("(ssii)"));
+               g_variant_builder_add(builder, "s", *dbmsg->file);
+               g_variant_builder_add(builder, "s", *dbmsg->asset);
+               g_variant_builder_add(builder, "i", dbmsg->vx);
+               g_variant_builder_add(builder, "i", dbmsg->vy);
+               }
+
+            if (builder != NULL) {
+               signals.Add(new cDBusSignal(NULL, "/OSD", DBUS_VDR_OSD_INTERFACE, dbmsg->action, g_variant_builder_end(builder), NULL, NULL));
+               g_variant_builder_unref(builder);
+               }
+            }
+        if (_object != NULL)
+           _object->Connection()->EmitSignal(signals);
+        // the files of the ring buffers can be written again
+        msgMutex.Lock();
+        for (cDbusOsdMsg *dbmsg = batch.First(); dbmsg; dbmsg = batch.Next(dbmsg)) {
+            if (dbmsg->ringFile)
+               g_hash_table_remove(busyFiles, *dbmsg->file);
+            }
+        msgMutex.Unlock();
+        // the files of closed osds are deleted with their messages
+        batch.Clear();
         }
 }
 
+#if APIVERSNUM >= 20000
+// FNV-1a over the size and the pixels
+static guint64 HashImage(const cImage &Image)
+{
+  guint64 hash = 14695981039346656037ULL;
+  guint32 size[2] = { (guint32)Image.Width(), (guint32)Image.Height() };
+  const uchar *p = (const uchar*)size;
+  for (size_t i = 0; i < sizeof(size); i++)
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+  p = (const uchar*)Image.Data();
+  size_t len = Image.Width() * Image.Height() * sizeof(tColor);
+  for (size_t i = 0; i < len; i++)
+      hash = (hash ^ p[i]) * 1099511628211ULL;
+  return hash;
+}
+
+int cDBusOsdProvider::StoreImageData(const cImage &Image)
+{
+  // vdr still needs the image to draw it into the pixmaps
+  int handle = cOsdProvider::StoreImageData(Image);
+  if ((handle == 0) || (_encoder == NULL))
+     return handle;
+
+  cString asset = cString::sprintf("%016llx", (unsigned long long)HashImage(Image));
+  cMutexLock MutexLock(&imageMutex);
+  g_hash_table_insert(imageHandles, GINT_TO_POINTER(handle), g_strdup(*asset));
+  tDBusOsdImage *image = (tDBusOsdImage*)g_hash_table_lookup(imageAssets, *asset);
+  if (image != NULL) {
+     image->refs++;
+     return handle;
+     }
+
+  if (!MakeDirs(*imageDir, true))
+     esyslog("dbus2vdr: can't create %s", *imageDir);
+  // the counter keeps a re-stored image apart from a dropped one which isn't deleted yet
+  cString filename = cString::sprintf("%s/%s-%u.%s", *imageDir, *asset, imageCounter++, _encoder->Extension());
+  image = g_new0(tDBusOsdImage, 1);
+  image->refs = 1;
+  image->filename = g_strdup(*filename);
+  g_hash_table_insert(imageAssets, g_strdup(*asset), image);
+
+  int w = Image.Width();
+  int h = Image.Height();
+  tColor *data = MALLOC(tColor, w * h);
+  memcpy(data, Image.Data(), w * h * sizeof(tColor));
+  cDbusOsdMsg *msg = new cDbusOsdMsg("ImageStored", -1, filename, 0, 0, 0, 0);
+  msg->asset = asset;
+  SendEncoded(msg, (uchar*)data, w, h);
+  d4syslog("dbus2vdr: stored image %d as %s", handle, *filename);
+  return handle;
+}
+
+void cDBusOsdProvider::DropImageData(int ImageHandle)
+{
+  cOsdProvider::DropImageData(ImageHandle);
+
+  cMutexLock MutexLock(&imageMutex);
+  const char *asset = (const char*)g_hash_table_lookup(imageHandles, GINT_TO_POINTER(ImageHandle));
+  tDBusOsdImage *image = (asset != NULL) ? (tDBusOsdImage*)g_hash_table_lookup(imageAssets, asset) : NULL;
+  if ((image != NULL) && (--image->refs == 0)) {
+     // the file is deleted with the message
+     cDbusOsdMsg *msg = new cDbusOsdMsg("ImageDropped", -1, image->filename, 0, 0, 0, 0);
+     msg->asset = asset;
+     SendMessage(msg);
+     g_hash_table_remove(imageAssets, asset);
+     }
+  g_hash_table_remove(imageHandles, GINT_TO_POINTER(ImageHandle));
+}
+#endif
+
+void cDBusOsdProvider::FreeImage(gpointer Data)
+{
+  tDBusOsdImage *image = (tDBusOsdImage*)Data;
+  g_free(image->filename);
+  g_free(image);
+}
+
+cString cDBusOsdProvider::AcquireRingFile(const char *OsdDir, int Counter, const cRect &ViewPort)
+{
+  if ((_keepFiles <= 0) || (_encoder == NULL))
+     return NULL;
+  cMutexLock MutexLock(&msgMutex);
+  for (int i = 0; i < _keepFiles; i++) {
+      cString filename = cString::sprintf("%s/%d-%d-%dx%d-%04x.%s", OsdDir, ViewPort.X(), ViewPort.Y(), ViewPort.Width(), ViewPort.Height(), (Counter + i) % _keepFiles, _encoder->Extension());
+      if (!g_hash_table_contains(busyFiles, *filename)) {
+         g_hash_table_add(busyFiles, g_strdup(*filename));
+         return filename;
+         }
+      }
+  return NULL;
+}
+
+cString cDBusOsdProvider::ImageAsset(int ImageHandle)
+{
+  cMutexLock MutexLock(&imageMutex);
+  const char *asset = (const char*)g_hash_table_lookup(imageHandles, GINT_TO_POINTER(ImageHandle));
+  return asset;
+}
+
+bool cDBusOsdProvider::SetDefaultMode(const char *Mode)
+{
+  if ((Mode == NULL) || (strcasecmp(Mode, "files") == 0) || (strcasecmp(Mode, "png") == 0))
+     _defaultMode = modeFiles;
+  else if (strcasecmp(Mode, "shm") == 0)
+     _defaultMode = modeShm;
+  else
+     return false;
+  return true;
+}
+
+bool cDBusOsdProvider::SetDirectory(const char *Directory)
+{
+  if ((Directory == NULL) || (*Directory != '/'))
+     return false;
+  _directory = Directory;
+  // without the trailing slashes
+  char *d = (char*)*_directory;
+  for (int len = strlen(d); (len > 1) && (d[len - 1] == '/'); len--)
+      d[len - 1] = 0;
+  return true;
+}
+
+bool cDBusOsdProvider::SetDefaultEncoder(const char *Encoder)
+{
+  cDBusOsdEncoder *encoder = cDBusOsdEncoder::Create(Encoder);
+  if (encoder == NULL)
+     return false;
+  delete encoder;
+  _defaultEncoder = Encoder;
+  return true;
+}
+
+void cDBusOsdProvider::AddOsd(cDBusOsd *Osd)
+{
+  cMutexLock MutexLock(&osdMutex);
+  osds.Append(Osd);
+}
+
+void cDBusOsdProvider::DelOsd(cDBusOsd *Osd)
+{
+  cMutexLock MutexLock(&osdMutex);
+  osds.RemoveElement(Osd);
+}
+
 void cDBusOsdProvider::SendMessage(cDbusOsdMsg *Msg)
 {
   cMutexLock MutexLock(&msgMutex);
+  Msg->queued = cTimeMs::Now();
+  if (Msg->IsFrame()) {
+     // a queued frame is dropped if a newer one covers its area,
+     // whatever was drawn there in between is overwritten anyway
+     cRect area(Msg->vx, Msg->vy, Msg->width, Msg->height);
+     for (cDbusOsdMsg *m = msgQueue.Last(); m; m = msgQueue.Prev(m)) {
+         if (m->osd != Msg->osd)
+            continue;
+         if (!m->IsFrame())
+            break;
+         if (!m->dropped && area.Contains(cRect(m->vx, m->vy, m->width, m->height)))
+            m->dropped = true;
+         }
+     }
   msgQueue.Add(Msg);
   msgCond.Broadcast();
 }
 
+void cDBusOsdProvider::SendEncoded(cDbusOsdMsg *Msg, uchar *Data, int Width, int Height)
+{
+  tDBusOsdEncodeJob *job = g_new0(tDBusOsdEncodeJob, 1);
+  job->msg = Msg;
+  job->data = Data;
+  job->width = Width;
+  job->height = Height;
+  Msg->width = Width;
+  Msg->height = Height;
+  Msg->ready = false;
+  SendMessage(Msg);
+  if (encoderPool != NULL)
+     g_thread_pool_push(encoderPool, job, NULL);
+  else
+     EncodeJob(job, this);
+}
+
+bool cDBusOsdProvider::WriteFile(const cDBusOsdEncoder *Encoder, const char *FileName, const uchar *Data, int Width, int Height)
+{
+  // a client reading the file sees either the old or the new image, never a partial one
+  cString tmpname = cString::sprintf("%s.%d.tmp", FileName, cThread::ThreadId());
+  if (!Encoder->Write(*tmpname, Data, Width, Height)) {
+     unlink(*tmpname);
+     return false;
+     }
+  if (rename(*tmpname, FileName) != 0) {
+     LOG_ERROR_STR(FileName);
+     unlink(*tmpname);
+     return false;
+     }
+  return true;
+}
+
+void cDBusOsdProvider::EncodeJob(gpointer Data, gpointer UserData)
+{
+  tDBusOsdEncodeJob *job = (tDBusOsdEncodeJob*)Data;
+  cDBusOsdProvider *provider = (cDBusOsdProvider*)UserData;
+  provider->msgMutex.Lock();
+  bool dropped = job->msg->dropped;
+  provider->msgMutex.Unlock();
+  // there's no need to write a file which won't be signaled
+  if (!dropped)
+     WriteFile(provider->_encoder, *job->msg->file, job->data, job->width, job->height);
+  free(job->data);
+
+  // the message may be deleted by the signal thread as soon as it's ready
+  provider->msgMutex.Lock();
+  job->msg->ready = true;
+  provider->msgCond.Broadcast();
+  provider->msgMutex.Unlock();
+  g_free(job);
+}
+
 
 cDbusOsdMsg::~cDbusOsdMsg(void)
 {
-  if (strcmp(action, "Close") == 0) {
+  // there are no files in shared memory mode
+  if ((strcmp(action, "Close") == 0) && DirectoryOk(*file)) {
      isyslog("dbus2vdr: deleting osd files at %s", *file);
      RemoveFileOrDir(*file, false);
      }
+  else if (strcmp(action, "ImageDropped") == 0)
+     unlink(*file);
 }
 
 
@@ -216,6 +744,76 @@ public:
        }
     cDBusHelper::SendReply(Invocation, 900, "DBus-OSD-provider not active");
   };
+
+  static void Statistics(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(sv)"));
+    cDBusOsdProvider *provider = cDBusOsdProvider::_provider;
+    if (provider != NULL) {
+       cMutexLock MutexLock(&provider->msgMutex);
+       guint64 frames = provider->statFrames;
+       guint64 dropped = provider->statDropped;
+       gint32 queued = provider->msgQueue.Count();
+       guint32 avgLatency = (frames > 0) ? provider->statLatency / frames : 0;
+       guint32 maxLatency = provider->statMaxLatency;
+       gint32 maxFps = cDBusOsdProvider::_maxFps;
+       cDBusHelper::AddKeyValue(array, "Frames", "t", (void**)&frames);
+       cDBusHelper::AddKeyValue(array, "Dropped", "t", (void**)&dropped);
+       cDBusHelper::AddKeyValue(array, "Queued", "i", (void**)&queued);
+       cDBusHelper::AddKeyValue(array, "AvgLatency", "u", (void**)&avgLatency);
+       cDBusHelper::AddKeyValue(array, "MaxLatency", "u", (void**)&maxLatency);
+       cDBusHelper::AddKeyValue(array, "MaxFps", "i", (void**)&maxFps);
+       }
+    GVariant *a = g_variant_builder_end(array);
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new_tuple(&a, 1));
+    g_variant_builder_unref(array);
+  };
+
+  static void GetFramebuffer(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *osdid = NULL;
+    g_variant_get(Parameters, "(&s)", &osdid);
+
+    int replyCode = 550;
+    cString replyMessage = "DBus-OSD-provider not active";
+    int width = 0;
+    int height = 0;
+    gint32 handle = -1;
+    GUnixFDList *fdList = g_unix_fd_list_new();
+    cDBusOsdProvider *provider = cDBusOsdProvider::_provider;
+    if (provider != NULL) {
+       cMutexLock MutexLock(&provider->osdMutex);
+       replyCode = 501;
+       replyMessage = cString::sprintf("osd %s not found", osdid);
+       for (int i = 0; i < provider->osds.Size(); i++) {
+           cDBusOsd *osd = provider->osds[i];
+           if (strcmp(*osd->osd_dir, osdid) != 0)
+              continue;
+           if (osd->fb_fd < 0) {
+              replyCode = 550;
+              replyMessage = cString::sprintf("osd %s has no framebuffer", osdid);
+              break;
+              }
+           GError *err = NULL;
+           handle = g_unix_fd_list_append(fdList, osd->fb_fd, &err);
+           if (handle < 0) {
+              replyCode = 554;
+              replyMessage = cString::sprintf("can't pass framebuffer: %s", err->message);
+              g_error_free(err);
+              break;
+              }
+           replyCode = 250;
+           replyMessage = "ARGB32 framebuffer";
+           width = osd->fb_width;
+           height = osd->fb_height;
+           break;
+           }
+       }
+
+    GVariant *reply = g_variant_new("(ishiii)", replyCode, *replyMessage, handle, width, height, width * (int)sizeof(tColor));
+    g_dbus_method_invocation_return_value_with_unix_fd_list(Invocation, reply, (handle >= 0) ? fdList : NULL);
+    g_object_unref(fdList);
+  };
 };
 
 const char *cDBusOsdObjectHelper::_xmlNodeInfo =
@@ -242,6 +840,43 @@ const char *cDBusOsdObjectHelper::_xmlNodeInfo =
   "      <arg name=\"top\"       type=\"i\"/>\n"
   "      <arg name=\"vx\"        type=\"i\"/>\n"
   "      <arg name=\"vy\"        type=\"i\"/>\n"
+  "      <arg name=\"format\"    type=\"s\"/>\n"
+  "    </signal>\n"
+  "    <method name=\"Statistics\">\n"
+  "      <arg name=\"statistics\"   type=\"a(sv)\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"GetFramebuffer\">\n"
+  "      <arg name=\"osdid\"        type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"fd\"           type=\"h\" direction=\"out\"/>\n"
+  "      <arg name=\"width\"        type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"height\"       type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"stride\"       type=\"i\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <signal name=\"DisplayRect\">\n"
+  "      <arg name=\"osdid\"     type=\"s\"/>\n"
+  "      <arg name=\"seq\"       type=\"u\"/>\n"
+  "      <arg name=\"x\"         type=\"i\"/>\n"
+  "      <arg name=\"y\"         type=\"i\"/>\n"
+  "      <arg name=\"width\"     type=\"i\"/>\n"
+  "      <arg name=\"height\"    type=\"i\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"ImageStored\">\n"
+  "      <arg name=\"asset\"     type=\"s\"/>\n"
+  "      <arg name=\"filename\"  type=\"s\"/>\n"
+  "      <arg name=\"width\"     type=\"i\"/>\n"
+  "      <arg name=\"height\"    type=\"i\"/>\n"
+  "      <arg name=\"format\"    type=\"s\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"ImageDropped\">\n"
+  "      <arg name=\"asset\"     type=\"s\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"DrawImage\">\n"
+  "      <arg name=\"osdid\"     type=\"s\"/>\n"
+  "      <arg name=\"asset\"     type=\"s\"/>\n"
+  "      <arg name=\"x\"         type=\"i\"/>\n"
+  "      <arg name=\"y\"         type=\"i\"/>\n"
   "    </signal>\n"
   "    <signal name=\"Close\">\n"
   "      <arg name=\"osdid\"  type=\"s\"/>\n"
@@ -254,6 +889,8 @@ cDBusOsdObject::cDBusOsdObject(void)
 {
   AddMethod("CreateProvider", cDBusOsdObjectHelper::CreateProvider);
   AddMethod("DeleteProvider", cDBusOsdObjectHelper::DeleteProvider);
+  AddMethod("GetFramebuffer", cDBusOsdObjectHelper::GetFramebuffer);
+  AddMethod("Statistics", cDBusOsdObjectHelper::Statistics);
 }
 
 cDBusOsdObject::~cDBusOsdObject(void)
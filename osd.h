@@ -6,12 +6,14 @@
 #include <vdr/osd.h>
 
 
+class cDBusOsdEncoder;
 class cDBusOsdProvider;
 
 class cDBusOsd : public cOsd
 {
 private:
   friend class cDBusOsdProvider;
+  friend class cDBusOsdObjectHelper;
 
   static int   osd_number;
 
@@ -21,6 +23,19 @@ private:
   cString      osd_dir;
   int          counter;
 
+  // in shared memory mode the framebuffer is passed to the clients,
+  // otherwise it holds the content of the written files
+  int          fb_fd;
+  tColor      *fb_data;
+  int          fb_width;
+  int          fb_height;
+
+  void CreateFramebuffer(void);
+  // copies the changed tiles of the clipped area X1,Y1-X2,Y2 of the pixmap
+  // at SrcX,SrcY into the framebuffer and adds the changed parts to Rects
+  void DiffTiles(const tColor *Src, int SrcX, int SrcY, int SrcWidth, int X1, int Y1, int X2, int Y2, cVector<cRect> &Rects);
+  void SendRect(const cRect &Rect);
+
 protected:
   cDBusOsd(cDBusOsdProvider& Provider, int Left, int Top, uint Level);
   // virtual void SetActive(bool On) { cOsd::SetActive(On); }
@@ -31,7 +46,10 @@ public:
   // virtual cPixmap *CreatePixmap(int Layer, const cRect &ViewPort, const cRect &DrawPort = cRect::Null);
   // virtual void DestroyPixmap(cPixmap *Pixmap);
   // virtual void DrawImage(const cPoint &Point, const cImage &Image);
-  // virtual void DrawImage(const cPoint &Point, int ImageHandle);
+#if APIVERSNUM >= 20000
+  // announces the stored image with its position
+  virtual void DrawImage(const cPoint &Point, int ImageHandle);
+#endif
   // virtual eOsdError CanHandleAreas(const tArea *Areas, int NumAreas) { return cOsd::CanHandleAreas(Areas, NumAreas); }
   // virtual eOsdError SetAreas(const tArea *Areas, int NumAreas);
 
@@ -66,14 +84,31 @@ class cDbusOsdMsg : public cListObject
 {
 public:
   const char *action;
+  int         osd;    // index of the osd
   cString     file;
   int         left, top, vx, vy;
+  int         width, height;
+  guint32     seq;
+  bool        ready;   // false while the file is encoded
+  bool        dropped; // superseded by a newer frame
+  uint64_t    queued;  // ms
+  cString     asset;   // id of a stored image
+  bool        ringFile; // file is a busy file of the ring buffer of the osd
+
+  cDbusOsdMsg(const char *Action, int Osd, const cString& File, int Left, int Top, int Vx, int Vy)
+   :action(Action),osd(Osd),file(File),left(Left),top(Top),vx(Vx),vy(Vy),width(0),height(0),seq(0),ready(true),dropped(false),queued(0),ringFile(false)
+  {
+  }
 
-  cDbusOsdMsg(const char *Action, const cString& File, int Left, int Top, int Vx, int Vy)
-   :action(Action),file(File),left(Left),top(Top),vx(Vx),vy(Vy)
+  // for "DisplayRect", the rectangle is in the coordinates of the framebuffer
+  cDbusOsdMsg(const char *Action, int Osd, const cString& File, guint32 Seq, int X, int Y, int Width, int Height)
+   :action(Action),osd(Osd),file(File),left(0),top(0),vx(X),vy(Y),width(Width),height(Height),seq(Seq),ready(true),dropped(false),queued(0),ringFile(false)
   {
   }
 
+  // "Display" or "DisplayRect"
+  bool IsFrame(void) const { return strncmp(action, "Display", 7) == 0; }
+
   virtual ~cDbusOsdMsg(void);
 };
 
@@ -83,21 +118,63 @@ class cDBusOsdProvider : public cOsdProvider, public cThread
 {
 friend class cDBusOsdObjectHelper;
 
+public:
+  enum eMode { modeFiles, modeShm };
+
 private:
   static cDBusOsdProvider *_provider;
+  static eMode             _defaultMode;
+  static cString           _defaultEncoder;
+  static int               _maxFps;
+  static int               _keepFiles;
+  static cString           _directory;
 
   cDBusObject       *_object;
+  eMode              _mode;
+  cDBusOsdEncoder   *_encoder; // only with modeFiles
+
+  cMutex             osdMutex;
+  cVector<cDBusOsd*> osds;
 
   cMutex             msgMutex;
   cCondVar           msgCond;
   cList<cDbusOsdMsg> msgQueue;
+  bool               msgStop;    // no more messages will be queued
+  GHashTable        *nextFrames; // osd index -> earliest time of the next frame
+  GHashTable        *busyFiles;  // files of the ring buffers with a queued message
+
+  // statistics, protected by msgMutex
+  guint64            statFrames;
+  guint64            statDropped;
+  guint64            statLatency; // sum of ms between queuing and emitting
+  guint32            statMaxLatency;
+
+  // with msgMutex locked, returns the first message which may be emitted or NULL,
+  // Wait is set to the ms until the first waiting frame is due unless it's
+  // already positive and lower, it's left unchanged for files not yet written
+  cDbusOsdMsg *NextMessage(int &Wait);
+
+  GThreadPool       *encoderPool;
+
+  // images stored by the skins, every distinct image is written only once
+  cMutex             imageMutex;
+  cString            imageDir;
+  GHashTable        *imageHandles; // handle -> asset id
+  GHashTable        *imageAssets;  // asset id -> tDBusOsdImage
+  guint32            imageCounter;
+
+  static bool WriteFile(const cDBusOsdEncoder *Encoder, const char *FileName, const uchar *Data, int Width, int Height);
+  static void EncodeJob(gpointer Data, gpointer UserData);
+  static void FreeImage(gpointer Data);
 
 protected:
   virtual cOsd *CreateOsd(int Left, int Top, uint Level);
   virtual bool ProvidesTrueColor(void) { return true; }
 
-  // virtual int StoreImageData(const cImage &Image);
-  // virtual void DropImageData(int ImageHandle);
+#if APIVERSNUM >= 20000
+  virtual int StoreImageData(const cImage &Image);
+  virtual void DropImageData(int ImageHandle);
+#endif
 
   virtual void Action(void);
 
@@ -105,7 +182,38 @@ public:
   cDBusOsdProvider(cDBusObject *Object);
   virtual ~cDBusOsdProvider();
 
+  static bool  SetDefaultMode(const char *Mode);
+  // returns false if the encoder is unknown, see cDBusOsdEncoder::Create
+  static bool  SetDefaultEncoder(const char *Encoder);
+  // 0 is unlimited
+  static void  SetMaxFps(int MaxFps) { _maxFps = MaxFps; }
+  // number of image files per osd, 0 keeps all files until the osd is closed
+  static void  SetKeepFiles(int KeepFiles) { _keepFiles = KeepFiles; }
+  static int   KeepFiles(void) { return _keepFiles; }
+  // absolute path, returns false if it's not
+  static bool  SetDirectory(const char *Directory);
+  static const char *Directory(void) { return *_directory; }
+  eMode Mode(void) const { return _mode; }
+  const cDBusOsdEncoder *Encoder(void) const { return _encoder; }
+
+  // with a limited number of files per viewport of an osd they're used like
+  // a ring buffer, the geometry is part of the name, so a file is only reused
+  // for a rectangle at the same position with the same size,
+  // a file stays busy until its message has been emitted or dropped,
+  // returns NULL if all files of the viewport are busy
+  cString AcquireRingFile(const char *OsdDir, int Counter, const cRect &ViewPort);
+
+  // the asset id of a stored image, NULL if unknown
+  cString ImageAsset(int ImageHandle);
+
+  void AddOsd(cDBusOsd *Osd);
+  void DelOsd(cDBusOsd *Osd);
+
+  // a new frame drops all queued frames of the same osd within its area
   void SendMessage(cDbusOsdMsg *Msg);
+  // writes the BGRA pixels to Msg->file in a worker thread and takes ownership of Data,
+  // the message is queued immediately but signaled when the file is written
+  void SendEncoded(cDbusOsdMsg *Msg, uchar *Data, int Width, int Height);
 };
 
 class cDBusOsdObject : public cDBusObject
@@ -0,0 +1,284 @@
+#include "osdencoder.h"
+#include "swizzle.h"
+
+#include <stdio.h>
+#include <zlib.h>
+
+// png++ isn't needed anymore, the old switch disables writing PNGs, too
+#if defined(NO_PNGPP) && !defined(NO_PNG)
+#define NO_PNG
+#endif
+
+#ifndef NO_PNG
+#include <png.h>
+#endif
+
+#define OSDENCODER_BUFSIZE 65536
+
+static FILE *OpenFile(const char *FileName)
+{
+  FILE *f = fopen(FileName, "wb");
+  if (f == NULL)
+     LOG_ERROR_STR(FileName);
+  return f;
+}
+
+static bool CloseFile(FILE *f, const char *FileName, bool Ok)
+{
+  if ((fclose(f) != 0) || !Ok) {
+     esyslog("dbus2vdr: can't write %s", FileName);
+     return false;
+     }
+  return true;
+}
+
+// header of the raw and zlib formats: magic, width and height in big endian
+static bool WriteRawHeader(FILE *f, const char *Magic, int Width, int Height)
+{
+  uchar header[12];
+  memcpy(header, Magic, 4);
+  for (int i = 0; i < 4; i++) {
+      header[4 + i] = (Width >> (24 - i * 8)) & 0xFF;
+      header[8 + i] = (Height >> (24 - i * 8)) & 0xFF;
+      }
+  return fwrite(header, sizeof(header), 1, f) == 1;
+}
+
+
+// the pixels as they are, no conversion at all
+class cDBusOsdEncoderRaw : public cDBusOsdEncoder
+{
+public:
+  virtual const char *Format(void) const { return "raw"; };
+  virtual const char *Extension(void) const { return "raw"; };
+
+  virtual bool Write(const char *FileName, const uchar *Data, int Width, int Height) const
+  {
+    FILE *f = OpenFile(FileName);
+    if (f == NULL)
+       return false;
+    bool ok = WriteRawHeader(f, "ARGB", Width, Height)
+           && (fwrite(Data, Width * 4, Height, f) == (size_t)Height);
+    return CloseFile(f, FileName, ok);
+  };
+};
+
+
+// like the raw format but the pixels are deflated
+class cDBusOsdEncoderZlib : public cDBusOsdEncoder
+{
+private:
+  int _level;
+
+public:
+  cDBusOsdEncoderZlib(int Level) :_level(Level) {};
+
+  virtual const char *Format(void) const { return "zlib"; };
+  virtual const char *Extension(void) const { return "raw.zlib"; };
+
+  virtual bool Write(const char *FileName, const uchar *Data, int Width, int Height) const
+  {
+    FILE *f = OpenFile(FileName);
+    if (f == NULL)
+       return false;
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (deflateInit(&z, _level) != Z_OK)
+       return CloseFile(f, FileName, false);
+
+    bool ok = WriteRawHeader(f, "ARGZ", Width, Height);
+    uchar *out = MALLOC(uchar, OSDENCODER_BUFSIZE);
+    z.next_in = (Bytef*)Data;
+    z.avail_in = Width * Height * 4;
+    int ret = Z_OK;
+    while (ok && (ret != Z_STREAM_END)) {
+          z.next_out = out;
+          z.avail_out = OSDENCODER_BUFSIZE;
+          ret = deflate(&z, Z_FINISH);
+          size_t len = OSDENCODER_BUFSIZE - z.avail_out;
+          if (((ret != Z_OK) && (ret != Z_STREAM_END) && (ret != Z_BUF_ERROR)) || (fwrite(out, 1, len, f) != len))
+             ok = false;
+          }
+    deflateEnd(&z);
+    free(out);
+    return CloseFile(f, FileName, ok);
+  };
+};
+
+
+// "Quite OK Image Format", see https://qoiformat.org/qoi-specification.pdf
+class cDBusOsdEncoderQoi : public cDBusOsdEncoder
+{
+private:
+  static void Put32(uchar *&p, uint32_t Value)
+  {
+    *p++ = (Value >> 24) & 0xFF;
+    *p++ = (Value >> 16) & 0xFF;
+    *p++ = (Value >> 8) & 0xFF;
+    *p++ = Value & 0xFF;
+  };
+
+public:
+  virtual const char *Format(void) const { return "qoi"; };
+  virtual const char *Extension(void) const { return "qoi"; };
+
+  virtual bool Write(const char *FileName, const uchar *Data, int Width, int Height) const
+  {
+    FILE *f = OpenFile(FileName);
+    if (f == NULL)
+       return false;
+
+    // worst case: every pixel as QOI_OP_RGBA plus header and end marker
+    size_t pixels = (size_t)Width * Height;
+    uchar *buffer = MALLOC(uchar, 14 + pixels * 5 + 8);
+    uchar *p = buffer;
+    memcpy(p, "qoif", 4);
+    p += 4;
+    Put32(p, Width);
+    Put32(p, Height);
+    *p++ = 4; // channels
+    *p++ = 0; // sRGB with linear alpha
+
+    uchar index[64][4];
+    memset(index, 0, sizeof(index));
+    uchar prev[4] = { 0, 0, 0, 255 };
+    int run = 0;
+    for (size_t i = 0; i < pixels; i++) {
+        const uchar *s = Data + i * 4;
+        uchar px[4] = { s[2], s[1], s[0], s[3] };
+        if (memcmp(px, prev, 4) == 0) {
+           run++;
+           if ((run == 62) || (i == pixels - 1)) {
+              *p++ = 0xC0 | (run - 1);  // QOI_OP_RUN
+              run = 0;
+              }
+           continue;
+           }
+        if (run > 0) {
+           *p++ = 0xC0 | (run - 1);
+           run = 0;
+           }
+        int pos = (px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64;
+        if (memcmp(index[pos], px, 4) == 0)
+           *p++ = pos;                  // QOI_OP_INDEX
+        else {
+           memcpy(index[pos], px, 4);
+           if (px[3] == prev[3]) {
+              signed char vr = px[0] - prev[0];
+              signed char vg = px[1] - prev[1];
+              signed char vb = px[2] - prev[2];
+              signed char vgr = vr - vg;
+              signed char vgb = vb - vg;
+              if ((vr > -3) && (vr < 2) && (vg > -3) && (vg < 2) && (vb > -3) && (vb < 2))
+                 *p++ = 0x40 | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2); // QOI_OP_DIFF
+              else if ((vgr > -9) && (vgr < 8) && (vg > -33) && (vg < 32) && (vgb > -9) && (vgb < 8)) {
+                 *p++ = 0x80 | (vg + 32); // QOI_OP_LUMA
+                 *p++ = ((vgr + 8) << 4) | (vgb + 8);
+                 }
+              else {
+                 *p++ = 0xFE;             // QOI_OP_RGB
+                 *p++ = px[0];
+                 *p++ = px[1];
+                 *p++ = px[2];
+                 }
+              }
+           else {
+              *p++ = 0xFF;                // QOI_OP_RGBA
+              memcpy(p, px, 4);
+              p += 4;
+              }
+           }
+        memcpy(prev, px, 4);
+        }
+    static const uchar padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    memcpy(p, padding, sizeof(padding));
+    p += sizeof(padding);
+
+    size_t len = p - buffer;
+    bool ok = (fwrite(buffer, 1, len, f) == len);
+    free(buffer);
+    return CloseFile(f, FileName, ok);
+  };
+};
+
+
+#ifndef NO_PNG
+class cDBusOsdEncoderPng : public cDBusOsdEncoder
+{
+private:
+  bool _fast;
+
+public:
+  cDBusOsdEncoderPng(bool Fast) :_fast(Fast) {};
+
+  virtual const char *Format(void) const { return "png"; };
+  virtual const char *Extension(void) const { return "png"; };
+
+  virtual bool Write(const char *FileName, const uchar *Data, int Width, int Height) const
+  {
+    FILE *f = OpenFile(FileName);
+    if (f == NULL)
+       return false;
+
+    // every row is converted into the same buffer right before it's compressed
+    uchar *row = MALLOC(uchar, Width * 4);
+    volatile bool ok = false;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = (png != NULL) ? png_create_info_struct(png) : NULL;
+    if ((info != NULL) && (row != NULL) && (setjmp(png_jmpbuf(png)) == 0)) {
+       png_init_io(png, f);
+       if (_fast) {
+          // one cheap filter for all rows and the fastest compression
+          png_set_filter(png, PNG_FILTER_TYPE_BASE, PNG_FILTER_SUB);
+          png_set_compression_level(png, Z_BEST_SPEED);
+          }
+       png_set_IHDR(png, info, Width, Height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+       png_write_info(png, info);
+       for (int y = 0; y < Height; y++) {
+           BgraToRgba(row, Data + y * Width * 4, Width);
+           png_write_row(png, row);
+           }
+       png_write_end(png, NULL);
+       ok = true;
+       }
+    if (png != NULL)
+       png_destroy_write_struct(&png, (info != NULL) ? &info : NULL);
+    free(row);
+    return CloseFile(f, FileName, ok);
+  };
+};
+#endif
+
+
+cDBusOsdEncoder *cDBusOsdEncoder::Create(const char *Name)
+{
+  if (Name == NULL)
+     Name = "png";
+  const char *arg = strchr(Name, ':');
+  int len = (arg != NULL) ? arg - Name : strlen(Name);
+  if (arg != NULL)
+     arg++;
+
+  if ((len == 3) && (strncasecmp(Name, "raw", len) == 0) && (arg == NULL))
+     return new cDBusOsdEncoderRaw;
+  if ((len == 3) && (strncasecmp(Name, "qoi", len) == 0) && (arg == NULL))
+     return new cDBusOsdEncoderQoi;
+  if ((len == 4) && (strncasecmp(Name, "zlib", len) == 0)) {
+     int level = Z_DEFAULT_COMPRESSION;
+     if (arg != NULL) {
+        char *end = NULL;
+        level = strtol(arg, &end, 10);
+        if ((end == arg) || (*end != 0) || (level < 0) || (level > 9))
+           return NULL;
+        }
+     return new cDBusOsdEncoderZlib(level);
+     }
+#ifndef NO_PNG
+  if ((len == 3) && (strncasecmp(Name, "png", len) == 0)) {
+     if ((arg != NULL) && (strcasecmp(arg, "fast") != 0))
+        return NULL;
+     return new cDBusOsdEncoderPng(arg != NULL);
+     }
+#endif
+  return NULL;
+}
@@ -0,0 +1,25 @@
+#ifndef __DBUS2VDR_OSDENCODER_H
+#define __DBUS2VDR_OSDENCODER_H
+
+#include <vdr/tools.h>
+
+
+// writes the pixels of an OSD part to a file,
+// must be thread safe since the files are written by a pool of threads
+class cDBusOsdEncoder
+{
+public:
+  virtual ~cDBusOsdEncoder(void) {};
+
+  // announced in the "Display" signal
+  virtual const char *Format(void) const = 0;
+  virtual const char *Extension(void) const = 0;
+  // Data is an array of vdr's tColor (ARGB in host byte order)
+  virtual bool Write(const char *FileName, const uchar *Data, int Width, int Height) const = 0;
+
+  // "raw", "qoi", "zlib[:level]", "png[:fast]", NULL is "png"
+  // returns NULL if the encoder is unknown or not available
+  static cDBusOsdEncoder *Create(const char *Name);
+};
+
+#endif
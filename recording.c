@@ -1,12 +1,372 @@
 #include "recording.h"
 #include "common.h"
 #include "helper.h"
+#include "connection.h"
+#include "recordingcache.h"
+#include "recordingjob.h"
+#include "recordingscanner.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gio/gunixfdlist.h>
 
 #include <vdr/menu.h>
 #include <vdr/recording.h>
 #include <vdr/videodir.h>
 
 
+// like in vdr's recording.c
+#define INDEXFILESUFFIX     "/index"
+#define MARKSFILESUFFIX     "/marks"
+#define PESFILESUFFIX       ".vdr"
+#define INDEXENTRYSIZE      8 // sizeof(tIndexTs) and sizeof(tIndexPes)
+
+class cDBusRecordingsFolder : public cListObject
+{
+private:
+  gchar *_name;
+
+  void Account(const cRecording *Recording, int SizeMB)
+  {
+    count++;
+    sizeMB += SizeMB;
+    if (Recording->Start() > start)
+       start = Recording->Start();
+  };
+
+  cDBusRecordingsFolder *GetFolder(const char *Name, int Length)
+  {
+    for (cDBusRecordingsFolder *f = folders.First(); f; f = folders.Next(f)) {
+        if ((strncmp(f->_name, Name, Length) == 0) && (f->_name[Length] == 0))
+           return f;
+        }
+    cDBusRecordingsFolder *f = new cDBusRecordingsFolder(Name, Length);
+    folders.Add(f);
+    return f;
+  };
+
+public:
+  cList<cDBusRecordingsFolder> folders;
+  cVector<const cRecording*>   recordings;
+  int     count;   // number of recordings including all subfolders
+  guint64 sizeMB;  // size of the recordings including all subfolders
+  time_t  start;   // start of the newest recording
+
+  cDBusRecordingsFolder(const char *Name, int Length)
+   :_name(g_strndup(Name, Length)), count(0), sizeMB(0), start(0) {};
+  virtual ~cDBusRecordingsFolder(void) { g_free(_name); };
+
+  const char *Name(void) const { return _name; };
+
+  void Clear(void)
+  {
+    folders.Clear();
+    recordings.Clear();
+    count = 0;
+    sizeMB = 0;
+    start = 0;
+  };
+
+  void Add(const cRecording *Recording)
+  {
+    int size = -1;
+    int numFrames = -1;
+    int length = -1;
+    // called with a read lock on the recordings for all of them,
+    // so the size is never computed here, unknown sizes count as 0
+    cDBusRecordingCache::Get(Recording, size, numFrames, length, false);
+    if (size < 0)
+       size = 0;
+    cDBusRecordingsFolder *folder = this;
+    const char *name = Recording->Name();
+    const char *delim = NULL;
+    while ((delim = strchr(name, FOLDERDELIMCHAR)) != NULL) {
+          folder->Account(Recording, size);
+          folder = folder->GetFolder(name, delim - name);
+          name = delim + 1;
+          }
+    folder->Account(Recording, size);
+    folder->recordings.Append(Recording);
+  };
+
+  // Path is like a recording name without the last part, "" is the root folder
+  cDBusRecordingsFolder *Find(const char *Path)
+  {
+    cDBusRecordingsFolder *folder = this;
+    while ((folder != NULL) && (Path != NULL) && *Path) {
+          const char *delim = strchr(Path, FOLDERDELIMCHAR);
+          int len = (delim != NULL) ? delim - Path : strlen(Path);
+          cDBusRecordingsFolder *f = NULL;
+          for (f = folder->folders.First(); f; f = folder->folders.Next(f)) {
+              if ((strncmp(f->_name, Path, len) == 0) && (f->_name[len] == 0))
+                 break;
+              }
+          folder = f;
+          Path = (delim != NULL) ? delim + 1 : NULL;
+          }
+    return folder;
+  };
+};
+
+typedef struct {
+  const cRecording *recording;
+  GHashTable       *tokens;    // token -> weight
+  guint             hash;      // of the indexed texts, to notice changed infos
+} tDBusSearchDocument;
+
+typedef struct {
+  tDBusSearchDocument *document;
+  int                  score;
+} tDBusSearchResult;
+
+// inverted index of the words in the names and infos of the recordings,
+// on changes of the recordings list only added, removed and changed recordings are indexed
+class cDBusRecordingsSearchIndex
+{
+private:
+  cMutex                     _mutex;
+  cDBusListIndex<cRecording> _index;
+  GHashTable                *_documents; // filename -> tDBusSearchDocument
+  GHashTable                *_postings;  // token -> (tDBusSearchDocument -> weight)
+  bool                       _changed;   // a document has been removed by Remove
+
+  static void FreeDocument(gpointer Data)
+  {
+    tDBusSearchDocument *doc = (tDBusSearchDocument*)Data;
+    g_hash_table_destroy(doc->tokens);
+    g_free(doc);
+  };
+
+  static void AddTokens(GHashTable *Tokens, const char *Text, int Weight)
+  {
+    if ((Text == NULL) || (*Text == 0))
+       return;
+    cString text = Text;
+    cDBusHelper::ToUtf8(text);
+    gchar *lower = g_utf8_strdown(*text, -1);
+    gchar *start = NULL;
+    for (gchar *p = lower; ; p = g_utf8_next_char(p)) {
+        gunichar c = g_utf8_get_char(p);
+        bool alnum = (c != 0) && g_unichar_isalnum(c);
+        if (alnum && (start == NULL))
+           start = p;
+        else if (!alnum && (start != NULL)) {
+           // ignore single characters
+           if (g_utf8_strlen(start, p - start) > 1) {
+              gchar *token = g_strndup(start, p - start);
+              if (GPOINTER_TO_INT(g_hash_table_lookup(Tokens, token)) < Weight)
+                 g_hash_table_insert(Tokens, token, GINT_TO_POINTER(Weight));
+              else
+                 g_free(token);
+              }
+           start = NULL;
+           }
+        if (c == 0)
+           break;
+        }
+    g_free(lower);
+  };
+
+  static guint TextHash(const cRecording *Recording)
+  {
+    guint hash = g_str_hash(Recording->Name());
+    const cRecordingInfo *info = Recording->Info();
+    if (info != NULL) {
+       const char *texts[] = { info->Title(), info->ShortText(), info->ChannelName(), info->Description() };
+       for (unsigned int i = 0; i < sizeof(texts) / sizeof(texts[0]); i++)
+           hash = hash * 31 + (texts[i] ? g_str_hash(texts[i]) : 0);
+       }
+    return hash;
+  };
+
+  void AddDocument(const cRecording *Recording)
+  {
+    tDBusSearchDocument *doc = g_new0(tDBusSearchDocument, 1);
+    doc->recording = Recording;
+    doc->hash = TextHash(Recording);
+    doc->tokens = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    AddTokens(doc->tokens, Recording->Name(), 3);
+    const cRecordingInfo *info = Recording->Info();
+    if (info != NULL) {
+       AddTokens(doc->tokens, info->Title(), 3);
+       AddTokens(doc->tokens, info->ShortText(), 2);
+       AddTokens(doc->tokens, info->ChannelName(), 2);
+       AddTokens(doc->tokens, info->Description(), 1);
+       }
+    g_hash_table_insert(_documents, g_strdup(Recording->FileName()), doc);
+
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, doc->tokens);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+          GHashTable *posting = (GHashTable*)g_hash_table_lookup(_postings, key);
+          if (posting == NULL) {
+             posting = g_hash_table_new(g_direct_hash, g_direct_equal);
+             g_hash_table_insert(_postings, g_strdup((const char*)key), posting);
+             }
+          g_hash_table_insert(posting, doc, value);
+          }
+  };
+
+  // the document itself is freed by the caller
+  void RemoveDocument(tDBusSearchDocument *Document)
+  {
+    GHashTableIter iter;
+    gpointer key;
+    g_hash_table_iter_init(&iter, Document->tokens);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+          GHashTable *posting = (GHashTable*)g_hash_table_lookup(_postings, key);
+          if (posting != NULL) {
+             g_hash_table_remove(posting, Document);
+             if (g_hash_table_size(posting) == 0)
+                g_hash_table_remove(_postings, key);
+             }
+          }
+  };
+
+  static gint CompareResults(gconstpointer A, gconstpointer B)
+  {
+    const tDBusSearchResult *a = (const tDBusSearchResult*)A;
+    const tDBusSearchResult *b = (const tDBusSearchResult*)B;
+    if (a->score != b->score)
+       return b->score - a->score;
+    if (a->document->recording->Start() != b->document->recording->Start())
+       return a->document->recording->Start() > b->document->recording->Start() ? -1 : 1;
+    return 0;
+  };
+
+  static gint ComparePostingSize(gconstpointer A, gconstpointer B)
+  {
+    return g_hash_table_size(*(GHashTable**)A) - g_hash_table_size(*(GHashTable**)B);
+  };
+
+  // must be called with a read lock on the recordings
+  void Update(const cRecordings *Recordings)
+  {
+    cDBusListIndex<cRecording>::cLock IndexLock(_index);
+    if (!_index.Update(Recordings) && !_changed)
+       return;
+    _changed = false;
+
+    // the pointers of all recordings may have changed,
+    // the infos may have been edited without changing the filename
+    int added = 0;
+    int removed = 0;
+    int changed = 0;
+    GHashTable *current = g_hash_table_new(g_str_hash, g_str_equal);
+    for (int i = 0; i < _index.Count(); i++) {
+        const cRecording *r = _index.Get(i);
+        g_hash_table_add(current, (gpointer)r->FileName());
+        tDBusSearchDocument *doc = (tDBusSearchDocument*)g_hash_table_lookup(_documents, r->FileName());
+        if (doc == NULL) {
+           AddDocument(r);
+           added++;
+           }
+        else if (doc->hash != TextHash(r)) {
+           RemoveDocument(doc);
+           g_hash_table_remove(_documents, r->FileName());
+           AddDocument(r);
+           changed++;
+           }
+        else
+           doc->recording = r;
+        }
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, _documents);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+          if (!g_hash_table_contains(current, key)) {
+             RemoveDocument((tDBusSearchDocument*)value);
+             g_hash_table_iter_remove(&iter);
+             removed++;
+             }
+          }
+    g_hash_table_destroy(current);
+    d4syslog("dbus2vdr: recordings search index: %d added, %d removed, %d changed, %u tokens", added, removed, changed, g_hash_table_size(_postings));
+  };
+
+public:
+  cDBusRecordingsSearchIndex(void)
+  {
+    _documents = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, FreeDocument);
+    _postings = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify)g_hash_table_destroy);
+    _changed = false;
+  };
+
+  virtual ~cDBusRecordingsSearchIndex(void)
+  {
+    g_hash_table_destroy(_postings);
+    g_hash_table_destroy(_documents);
+  };
+
+  // drops the document of a renamed recording, it's indexed again with the next Search
+  void Remove(const char *FileName)
+  {
+    cMutexLock MutexLock(&_mutex);
+    tDBusSearchDocument *doc = (tDBusSearchDocument*)g_hash_table_lookup(_documents, FileName);
+    if (doc != NULL) {
+       RemoveDocument(doc);
+       g_hash_table_remove(_documents, FileName);
+       }
+    _changed = true;
+  };
+
+  // must be called with a read lock on the recordings,
+  // all words of the query must match
+  void Search(const cRecordings *Recordings, const char *Query, int Limit, cVector<const cRecording*> &Result)
+  {
+    cMutexLock MutexLock(&_mutex);
+    Update(Recordings);
+
+    GHashTable *query = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    AddTokens(query, Query, 1);
+    GPtrArray *postings = g_ptr_array_new();
+    bool missing = (g_hash_table_size(query) == 0);
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, query);
+    while (!missing && g_hash_table_iter_next(&iter, &key, NULL)) {
+          GHashTable *posting = (GHashTable*)g_hash_table_lookup(_postings, key);
+          if (posting == NULL)
+             missing = true;
+          else
+             g_ptr_array_add(postings, posting);
+          }
+    g_hash_table_destroy(query);
+    if (missing) {
+       g_ptr_array_free(postings, TRUE);
+       return;
+       }
+
+    // check the candidates of the rarest word against the other words
+    g_ptr_array_sort(postings, ComparePostingSize);
+    GArray *results = g_array_new(FALSE, FALSE, sizeof(tDBusSearchResult));
+    g_hash_table_iter_init(&iter, (GHashTable*)g_ptr_array_index(postings, 0));
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+          tDBusSearchResult result;
+          result.document = (tDBusSearchDocument*)key;
+          result.score = GPOINTER_TO_INT(value);
+          for (guint i = 1; (result.score > 0) && (i < postings->len); i++) {
+              int weight = GPOINTER_TO_INT(g_hash_table_lookup((GHashTable*)g_ptr_array_index(postings, i), key));
+              result.score = (weight > 0) ? result.score + weight : 0;
+              }
+          if (result.score > 0)
+             g_array_append_val(results, result);
+          }
+    g_ptr_array_free(postings, TRUE);
+
+    g_array_sort(results, CompareResults);
+    for (guint i = 0; (i < results->len) && ((Limit <= 0) || (Result.Size() < Limit)); i++)
+        Result.Append(g_array_index(results, tDBusSearchResult, i).document->recording);
+    g_array_free(results, TRUE);
+  };
+};
+
 class cDBusRecordingsHelper
 {
 private:
@@ -16,6 +376,46 @@ private:
   static cRecordings recordings;
 #endif
 
+  // folder tree for Browse, rebuilt if the recordings list changes
+  static cMutex                    _treeMutex;
+  static cDBusListIndex<cRecording> _treeIndex;
+  static cDBusRecordingsFolder     _tree;
+  static guint                     _treeGeneration;
+
+  static cDBusRecordingsSearchIndex _searchIndex;
+
+  static int CompareFolderNames(const void *A, const void *B)
+  {
+    const cDBusRecordingsFolder *a = *(const cDBusRecordingsFolder**)A;
+    const cDBusRecordingsFolder *b = *(const cDBusRecordingsFolder**)B;
+    return strcasecmp(a->Name(), b->Name());
+  };
+
+  static int CompareFolderDates(const void *A, const void *B)
+  {
+    const cDBusRecordingsFolder *a = *(const cDBusRecordingsFolder**)A;
+    const cDBusRecordingsFolder *b = *(const cDBusRecordingsFolder**)B;
+    if (a->start != b->start)
+       return a->start < b->start ? -1 : 1;
+    return strcasecmp(a->Name(), b->Name());
+  };
+
+  static int CompareRecordingNames(const void *A, const void *B)
+  {
+    const cRecording *a = *(const cRecording**)A;
+    const cRecording *b = *(const cRecording**)B;
+    return strcasecmp(a->Name(), b->Name());
+  };
+
+  static int CompareRecordingDates(const void *A, const void *B)
+  {
+    const cRecording *a = *(const cRecording**)A;
+    const cRecording *b = *(const cRecording**)B;
+    if (a->Start() != b->Start())
+       return a->Start() < b->Start() ? -1 : 1;
+    return strcasecmp(a->Name(), b->Name());
+  };
+
 public:
   static const char *_xmlNodeInfoConst;
   static const char *_xmlNodeInfo;
@@ -62,12 +462,13 @@ public:
        i = recording->HierarchyLevels();
        cDBusHelper::AddKeyValue(array, "HierarchyLevels", "i", (void**)&i);
        cDBusHelper::AddKeyDouble(array, "FramesPerSecond", recording->FramesPerSecond());
-       i = recording->NumFrames();
-       cDBusHelper::AddKeyValue(array, "NumFrames", "i", (void**)&i);
-       i = recording->LengthInSeconds();
-       cDBusHelper::AddKeyValue(array, "LengthInSeconds", "i", (void**)&i);
-       i = recording->FileSizeMB();
-       cDBusHelper::AddKeyValue(array, "FileSizeMB", "i", (void**)&i);
+       int sizeMB = -1;
+       int numFrames = -1;
+       int length = -1;
+       cDBusRecordingCache::Get(recording, sizeMB, numFrames, length);
+       cDBusHelper::AddKeyValue(array, "NumFrames", "i", (void**)&numFrames);
+       cDBusHelper::AddKeyValue(array, "LengthInSeconds", "i", (void**)&length);
+       cDBusHelper::AddKeyValue(array, "FileSizeMB", "i", (void**)&sizeMB);
        b = recording->IsPesRecording() ? TRUE : FALSE;
        cDBusHelper::AddKeyValue(array, "IsPesRecording", "b", (void**)&b);
        b = recording->IsNew() ? TRUE : FALSE;
@@ -186,8 +587,141 @@ public:
     g_variant_builder_unref(array);
   };
 
+  static void Search(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *query = NULL;
+    int limit = 0;
+    g_variant_get(Parameters, "(&si)", &query, &limit);
+
+    const cRecordings *recs = NULL;
+#if VDRVERSNUM > 20300
+    LOCK_RECORDINGS_READ;
+    recs = Recordings;
+#else
+    recordings.Update(true);
+    recs = &recordings;
+#endif
+
+    cVector<const cRecording*> result;
+    _searchIndex.Search(recs, query, limit, result);
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(ia(sv))"));
+    for (int i = 0; i < result.Size(); i++)
+        g_variant_builder_add_value(array, BuildRecording(result[i]));
+    GVariant *a = g_variant_builder_end(array);
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new_tuple(&a, 1));
+    g_variant_builder_unref(array);
+  };
+
+  static void SendBrowseReply(GDBusMethodInvocation *Invocation, int ReplyCode, const char *ReplyMessage, GVariantBuilder *Folders, int Total, GVariantBuilder *Recordings)
+  {
+    GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(isa(sit)ia(ia(sv)))"));
+    g_variant_builder_add(builder, "i", ReplyCode);
+    g_variant_builder_add(builder, "s", ReplyMessage);
+    if (Folders != NULL)
+       g_variant_builder_add_value(builder, g_variant_builder_end(Folders));
+    else
+       g_variant_builder_add_value(builder, g_variant_new_array(G_VARIANT_TYPE("(sit)"), NULL, 0));
+    g_variant_builder_add(builder, "i", Total);
+    if (Recordings != NULL)
+       g_variant_builder_add_value(builder, g_variant_builder_end(Recordings));
+    else
+       g_variant_builder_add_value(builder, g_variant_new_array(G_VARIANT_TYPE("(ia(sv))"), NULL, 0));
+    g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
+    g_variant_builder_unref(builder);
+  };
+
+  static void Browse(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *path = NULL;
+    int offset = 0;
+    int limit = 0;
+    const char *sort = NULL;
+    g_variant_get(Parameters, "(&sii&s)", &path, &offset, &limit, &sort);
+
+    bool descending = false;
+    if (*sort == '-') {
+       descending = true;
+       sort++;
+       }
+    bool byDate = false;
+    if (strcasecmp(sort, "date") == 0)
+       byDate = true;
+    else if (*sort && (strcasecmp(sort, "name") != 0)) {
+       SendBrowseReply(Invocation, 501, *cString::sprintf("unknown sort order \"%s\"", sort), NULL, 0, NULL);
+       return;
+       }
+    if (offset < 0)
+       offset = 0;
+
+    const cRecordings *recs = NULL;
+#if VDRVERSNUM > 20300
+    LOCK_RECORDINGS_READ;
+    recs = Recordings;
+#else
+    recordings.Update(true);
+    recs = &recordings;
+#endif
+
+    cMutexLock MutexLock(&_treeMutex);
+    // the sizes of the folders may have changed, too
+    guint generation = cDBusRecordingCache::Generation();
+    cDBusListIndex<cRecording>::cLock IndexLock(_treeIndex);
+    if (_treeIndex.Update(recs) || (generation != _treeGeneration)) {
+       _treeGeneration = generation;
+       _tree.Clear();
+       for (int i = 0; i < _treeIndex.Count(); i++)
+           _tree.Add(_treeIndex.Get(i));
+       }
+
+    cDBusRecordingsFolder *folder = _tree.Find(path);
+    if (folder == NULL) {
+       SendBrowseReply(Invocation, 550, *cString::sprintf("folder \"%s\" not found", path), NULL, 0, NULL);
+       return;
+       }
+
+    cVector<cDBusRecordingsFolder*> folders;
+    for (cDBusRecordingsFolder *f = folder->folders.First(); f; f = folder->folders.Next(f))
+        folders.Append(f);
+    folders.Sort(byDate ? CompareFolderDates : CompareFolderNames);
+    GVariantBuilder *folderArray = g_variant_builder_new(G_VARIANT_TYPE("a(sit)"));
+    for (int i = 0; i < folders.Size(); i++) {
+        cDBusRecordingsFolder *f = folders[descending ? folders.Size() - 1 - i : i];
+        g_variant_builder_add(folderArray, "(sit)", f->Name(), f->count, f->sizeMB);
+        }
+
+    cVector<const cRecording*> leaves;
+    for (int i = 0; i < folder->recordings.Size(); i++)
+        leaves.Append(folder->recordings[i]);
+    leaves.Sort(byDate ? CompareRecordingDates : CompareRecordingNames);
+    int total = leaves.Size();
+    int end = total;
+    if ((limit > 0) && (offset + limit < total))
+       end = offset + limit;
+    GVariantBuilder *recArray = g_variant_builder_new(G_VARIANT_TYPE("a(ia(sv))"));
+    for (int i = offset; i < end; i++)
+        g_variant_builder_add_value(recArray, BuildRecording(leaves[descending ? total - 1 - i : i]));
+
+    SendBrowseReply(Invocation, 250, "", folderArray, total, recArray);
+    g_variant_builder_unref(folderArray);
+    g_variant_builder_unref(recArray);
+  };
+
   static void Update(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
+#ifdef EXTRA_VIDEO_DIRECTORIES_PATCH
+    // scan the video directories in parallel instead of one after the other
+    cStringList dirs;
+    cDBusRecordingScanner::GetDirectories(dirs);
+    if (dirs.Size() > 1) {
+       cString error;
+       for (int i = 0; i < dirs.Size(); i++) {
+           if (!cDBusRecordingScanner::Scan(dirs[i], error))
+              esyslog("dbus2vdr: %s", *error);
+           }
+       cDBusHelper::SendReply(Invocation, 250, "update of recordings triggered");
+       return;
+       }
+#endif
     cRecordings *recs = NULL;
 #if VDRVERSNUM > 20300
     LOCK_RECORDINGS_WRITE;
@@ -199,6 +733,42 @@ public:
     cDBusHelper::SendReply(Invocation, 250, "update of recordings triggered");
   };
 
+  static void UpdateDirectory(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *dir = NULL;
+    g_variant_get(Parameters, "(&s)", &dir);
+    if (*dir == 0) {
+       cDBusHelper::SendReply(Invocation, 501, "Missing directory name");
+       return;
+       }
+
+    cStringList dirs;
+    cDBusRecordingScanner::GetDirectories(dirs);
+    int len = strlen(dir);
+    while ((len > 1) && (dir[len - 1] == '/'))
+          len--;
+    for (int i = 0; i < dirs.Size(); i++) {
+        if ((strncmp(dirs[i], dir, len) == 0) && (dirs[i][len] == 0)) {
+           cString error;
+           if (cDBusRecordingScanner::Scan(dirs[i], error))
+              cDBusHelper::SendReply(Invocation, 250, *cString::sprintf("scan of %s started", dirs[i]));
+           else
+              cDBusHelper::SendReply(Invocation, 550, *error);
+           return;
+           }
+        }
+    cDBusHelper::SendReply(Invocation, 501, *cString::sprintf("%s is no video directory", dir));
+  };
+
+  static void ScanStatistics(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(siiitt)"));
+    cDBusRecordingScanner::GetStatistics(array);
+    GVariant *a = g_variant_builder_end(array);
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new_tuple(&a, 1));
+    g_variant_builder_unref(array);
+  };
+
   static void Play(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
     int replyCode = 501;
@@ -310,6 +880,254 @@ public:
     g_variant_unref(second);
   };
 
+  static bool GetRecordingFile(const char *Path, cString &FileName, bool &IsPesRecording, double &FramesPerSecond)
+  {
+#if VDRVERSNUM > 20300
+    LOCK_RECORDINGS_READ;
+    const cRecordings *recs = Recordings;
+#else
+    cThreadLock RecordingsLock(&Recordings);
+    cRecordings *recs = &Recordings;
+#endif
+    const cRecording *recording = recs->GetByName(Path);
+    if (recording == NULL)
+       return false;
+    FileName = recording->FileName();
+    IsPesRecording = recording->IsPesRecording();
+    FramesPerSecond = recording->FramesPerSecond();
+    return true;
+  };
+
+  // opens a file of the recording and appends it to the list, returns the handle
+  static int AppendRecordingFile(GDBusMethodInvocation *Invocation, const char *FileName, const char *Suffix, bool IsPesRecording, GUnixFDList *FdList, int &ReplyCode, cString &ReplyMessage)
+  {
+    GDBusConnection *connection = g_dbus_method_invocation_get_connection(Invocation);
+    if ((g_dbus_connection_get_capabilities(connection) & G_DBUS_CAPABILITY_FLAGS_UNIX_FD_PASSING) == 0) {
+       ReplyCode = 550;
+       ReplyMessage = "connection doesn't support passing of file descriptors";
+       return -1;
+       }
+
+    cString file = cString::sprintf("%s%s%s", FileName, Suffix, IsPesRecording ? PESFILESUFFIX : "");
+    int fd = open(*file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+       ReplyCode = 550;
+       ReplyMessage = cString::sprintf("can't open %s", *file);
+       return -1;
+       }
+    GError *err = NULL;
+    int handle = g_unix_fd_list_append(FdList, fd, &err);
+    close(fd);
+    if (handle < 0) {
+       ReplyCode = 550;
+       ReplyMessage = cString::sprintf("can't pass %s: %s", *file, err->message);
+       g_error_free(err);
+       return -1;
+       }
+    ReplyCode = 250;
+    ReplyMessage = "";
+    return handle;
+  };
+
+  static void GetIndex(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *path = NULL;
+    g_variant_get(Parameters, "(&s)", &path);
+
+    int replyCode = 501;
+    cString replyMessage = "Missing recording path";
+    int handle = -1;
+    gint32 frames = -1;
+    cString fileName;
+    bool isPes = false;
+    double fps = 0;
+    GUnixFDList *fdList = g_unix_fd_list_new();
+    if (*path) {
+       if (!GetRecordingFile(path, fileName, isPes, fps)) {
+          replyCode = 550;
+          replyMessage = cString::sprintf("recording \"%s\" not found", path);
+          }
+       else {
+          handle = AppendRecordingFile(Invocation, *fileName, INDEXFILESUFFIX, isPes, fdList, replyCode, replyMessage);
+          if (handle >= 0) {
+             struct stat st;
+             int fd = g_unix_fd_list_get(fdList, handle, NULL);
+             if ((fd >= 0) && (fstat(fd, &st) == 0))
+                frames = st.st_size / INDEXENTRYSIZE;
+             if (fd >= 0)
+                close(fd);
+             }
+          }
+       }
+
+    GVariant *reply = g_variant_new("(ishbdi)", replyCode, *replyMessage, handle, isPes ? TRUE : FALSE, fps, frames);
+    g_dbus_method_invocation_return_value_with_unix_fd_list(Invocation, reply, (handle >= 0) ? fdList : NULL);
+    g_object_unref(fdList);
+  };
+
+  static void GetMarks(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *path = NULL;
+    g_variant_get(Parameters, "(&s)", &path);
+
+    int replyCode = 501;
+    cString replyMessage = "Missing recording path";
+    int handle = -1;
+    cString fileName;
+    bool isPes = false;
+    double fps = 0;
+    GUnixFDList *fdList = g_unix_fd_list_new();
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(iss)"));
+    if (*path) {
+       if (!GetRecordingFile(path, fileName, isPes, fps)) {
+          replyCode = 550;
+          replyMessage = cString::sprintf("recording \"%s\" not found", path);
+          }
+       else {
+          cString marksFile = cString::sprintf("%s%s%s", *fileName, MARKSFILESUFFIX, isPes ? PESFILESUFFIX : "");
+          cMarks marks;
+          if (access(*marksFile, F_OK) != 0) {
+             // a recording without marks
+             replyCode = 250;
+             replyMessage = "no marks file";
+             }
+          else if (marks.Load(*fileName, fps, isPes)) {
+             // the decoded marks are returned even without the file descriptor,
+             // then the message tells why it's missing
+             handle = AppendRecordingFile(Invocation, *fileName, MARKSFILESUFFIX, isPes, fdList, replyCode, replyMessage);
+             replyCode = 250;
+             for (const cMark *m = marks.First(); m; m = marks.Next(m)) {
+                 cString hmsf = IndexToHMSF(m->Position(), true, fps);
+                 g_variant_builder_add(array, "(iss)", m->Position(), *hmsf, m->Comment() ? m->Comment() : "");
+                 }
+             }
+          else {
+             replyCode = 550;
+             replyMessage = cString::sprintf("can't load %s", *marksFile);
+             }
+          }
+       }
+
+    GVariant *reply = g_variant_new("(isha(iss))", replyCode, *replyMessage, handle, array);
+    g_dbus_method_invocation_return_value_with_unix_fd_list(Invocation, reply, (handle >= 0) ? fdList : NULL);
+    g_variant_builder_unref(array);
+    g_object_unref(fdList);
+  };
+
+  // checks the recording and returns the name of its directory for a new name
+  // and/or video directory, NewName and VideoDir may be NULL
+  static bool GetJobFileName(const char *Path, const char *NewName, const char *VideoDir, cString &FileName, cString &NewFileName, int &ReplyCode, cString &ReplyMessage)
+  {
+#if VDRVERSNUM > 20300
+    LOCK_RECORDINGS_READ;
+    const cRecordings *recs = Recordings;
+#else
+    cThreadLock RecordingsLock(&Recordings);
+    cRecordings *recs = &Recordings;
+#endif
+    const cRecording *recording = recs->GetByName(Path);
+    if (recording == NULL) {
+       ReplyCode = 550;
+       ReplyMessage = cString::sprintf("recording \"%s\" not found", Path);
+       return false;
+       }
+    if (int RecordingInUse = recording->IsInUse()) {
+       ReplyCode = 550;
+       ReplyMessage = cString::sprintf("recording is in use, reason %d", RecordingInUse);
+       return false;
+       }
+    FileName = recording->FileName();
+    if ((NewName == NULL) && (VideoDir == NULL))
+       return true;
+
+    // the filename is <video directory>/<name with '~' as '/'>/<basename>
+    const char *fileName = recording->FileName();
+    const char *base = strrchr(fileName, '/');
+    if (base == NULL) {
+       ReplyCode = 554;
+       ReplyMessage = cString::sprintf("invalid filename of recording \"%s\"", Path);
+       return false;
+       }
+    int levels = 1;
+    for (const char *c = recording->Name(); *c; c++) {
+        if (*c == FOLDERDELIMCHAR)
+           levels++;
+        }
+    const char *end = base;
+    while ((levels-- > 0) && (end > fileName)) {
+          end--;
+          while ((end > fileName) && (*end != '/'))
+                end--;
+          }
+    cString root = VideoDir;
+    if (VideoDir == NULL)
+       root = cString::sprintf("%.*s", (int)(end - fileName), fileName);
+    if (NewName != NULL) {
+       char *name = ExchangeChars(strdup(NewName), true);
+       NewFileName = cString::sprintf("%s/%s%s", *root, name, base);
+       free(name);
+       }
+    else
+       NewFileName = cString::sprintf("%s%s", *root, end);
+    return true;
+  };
+
+  static void SendJobReply(GDBusMethodInvocation *Invocation, int ReplyCode, const char *ReplyMessage, guint32 Id)
+  {
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new("(isu)", ReplyCode, ReplyMessage, Id));
+  };
+
+  static void StartJob(GDBusMethodInvocation *Invocation, const char *Path, const char *NewName, const char *VideoDir, bool Remove)
+  {
+    int replyCode = 501;
+    cString replyMessage;
+    cString fileName;
+    cString newFileName;
+    guint32 id = 0;
+    if ((Path == NULL) || (*Path == 0))
+       replyMessage = "Missing recording path";
+    else if ((NewName != NULL) && (*NewName == 0))
+       replyMessage = "Missing new recording name";
+    else if ((VideoDir != NULL) && (*VideoDir != '/'))
+       replyMessage = "Missing absolute path of video directory";
+    else if (GetJobFileName(Path, NewName, VideoDir, fileName, newFileName, replyCode, replyMessage)) {
+       if (Remove)
+          id = cDBusRecordingJobs::Delete(*fileName, replyMessage);
+       else
+          id = cDBusRecordingJobs::Move(*fileName, *newFileName, replyMessage);
+       if (id > 0) {
+          replyCode = 250;
+          replyMessage = cString::sprintf("job %u started", id);
+          }
+       else
+          replyCode = 554;
+       }
+    SendJobReply(Invocation, replyCode, *replyMessage, id);
+  };
+
+  static void Rename(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *path = NULL;
+    const char *newName = NULL;
+    g_variant_get(Parameters, "(&s&s)", &path, &newName);
+    StartJob(Invocation, path, newName, NULL, false);
+  };
+
+  static void Move(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *path = NULL;
+    const char *videoDir = NULL;
+    g_variant_get(Parameters, "(&s&s)", &path, &videoDir);
+    StartJob(Invocation, path, NULL, videoDir, false);
+  };
+
+  static void Delete(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    const char *path = NULL;
+    g_variant_get(Parameters, "(&s)", &path);
+    StartJob(Invocation, path, NULL, NULL, true);
+  };
+
   static void ChangeName(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
     int replyCode = 501;
@@ -378,7 +1196,10 @@ public:
 #else
           cString oldName = recording->Name();
 #endif
+          cString oldFileName = recording->FileName();
           if (recording->ChangeName(newName)) {
+             _searchIndex.Remove(*oldFileName);
+             _searchIndex.Remove(recording->FileName());
              // update list of vdr
              globalRecs->Update(false);
              replyCode = 250;
@@ -517,12 +1338,29 @@ public:
 #if VDRVERSNUM < 20300
 cRecordings cDBusRecordingsHelper::recordings;
 #endif
+cMutex                     cDBusRecordingsHelper::_treeMutex;
+cDBusListIndex<cRecording> cDBusRecordingsHelper::_treeIndex;
+cDBusRecordingsFolder      cDBusRecordingsHelper::_tree("", 0);
+guint                      cDBusRecordingsHelper::_treeGeneration = 0;
+cDBusRecordingsSearchIndex cDBusRecordingsHelper::_searchIndex;
 
 const char *cDBusRecordingsHelper::_xmlNodeInfoConst = 
   "<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\"\n"
   "       \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
   "<node>\n"
   "  <interface name=\""DBUS_VDR_RECORDING_INTERFACE"\">\n"
+  "    <signal name=\"Refreshed\">\n"
+  "      <arg name=\"Paths\"          type=\"as\" direction=\"out\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"JobProgress\">\n"
+  "      <arg name=\"Id\"             type=\"u\" direction=\"out\"/>\n"
+  "      <arg name=\"Percent\"        type=\"i\" direction=\"out\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"JobFinished\">\n"
+  "      <arg name=\"Id\"             type=\"u\" direction=\"out\"/>\n"
+  "      <arg name=\"ReplyCode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"ReplyMessage\"   type=\"s\" direction=\"out\"/>\n"
+  "    </signal>\n"
   "    <method name=\"Get\">\n"
   "      <arg name=\"number_or_path\" type=\"v\" direction=\"in\"/>\n"
   "      <arg name=\"recording\"      type=\"(ia(sv))\" direction=\"out\"/>\n"
@@ -530,6 +1368,22 @@ const char *cDBusRecordingsHelper::_xmlNodeInfoConst =
   "    <method name=\"List\">\n"
   "      <arg name=\"recordings\"   type=\"a(ia(sv))\" direction=\"out\"/>\n"
   "    </method>\n"
+  "    <method name=\"Search\">\n"
+  "      <arg name=\"query\"        type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"limit\"        type=\"i\" direction=\"in\"/>\n"
+  "      <arg name=\"recordings\"   type=\"a(ia(sv))\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"Browse\">\n"
+  "      <arg name=\"folder\"       type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"offset\"       type=\"i\" direction=\"in\"/>\n"
+  "      <arg name=\"limit\"        type=\"i\" direction=\"in\"/>\n"
+  "      <arg name=\"sort\"         type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"folders\"      type=\"a(sit)\" direction=\"out\"/>\n"
+  "      <arg name=\"total\"        type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"recordings\"   type=\"a(ia(sv))\" direction=\"out\"/>\n"
+  "    </method>\n"
 #ifdef EXTRA_VIDEO_DIRECTORIES_PATCH
   "    <method name=\"ListExtraVideoDirectories\">\n"
   "      <arg name=\"replycode\"      type=\"i\"  direction=\"out\"/>\n"
@@ -545,10 +1399,30 @@ const char *cDBusRecordingsHelper::_xmlNodeInfo =
   "       \"http://www.freedesktop.org/standards/dbus/1.0/introspect.dtd\">\n"
   "<node>\n"
   "  <interface name=\""DBUS_VDR_RECORDING_INTERFACE"\">\n"
+  "    <signal name=\"Refreshed\">\n"
+  "      <arg name=\"Paths\"          type=\"as\" direction=\"out\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"JobProgress\">\n"
+  "      <arg name=\"Id\"             type=\"u\" direction=\"out\"/>\n"
+  "      <arg name=\"Percent\"        type=\"i\" direction=\"out\"/>\n"
+  "    </signal>\n"
+  "    <signal name=\"JobFinished\">\n"
+  "      <arg name=\"Id\"             type=\"u\" direction=\"out\"/>\n"
+  "      <arg name=\"ReplyCode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"ReplyMessage\"   type=\"s\" direction=\"out\"/>\n"
+  "    </signal>\n"
   "    <method name=\"Update\">\n"
   "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
   "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
   "    </method>\n"
+  "    <method name=\"UpdateDirectory\">\n"
+  "      <arg name=\"directory\"    type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"ScanStatistics\">\n"
+  "      <arg name=\"statistics\"   type=\"a(siiitt)\" direction=\"out\"/>\n"
+  "    </method>\n"
   "    <method name=\"Get\">\n"
   "      <arg name=\"number_or_path\" type=\"v\" direction=\"in\"/>\n"
   "      <arg name=\"recording\"      type=\"(ia(sv))\" direction=\"out\"/>\n"
@@ -556,12 +1430,64 @@ const char *cDBusRecordingsHelper::_xmlNodeInfo =
   "    <method name=\"List\">\n"
   "      <arg name=\"recordings\"   type=\"a(ia(sv))\" direction=\"out\"/>\n"
   "    </method>\n"
+  "    <method name=\"Search\">\n"
+  "      <arg name=\"query\"        type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"limit\"        type=\"i\" direction=\"in\"/>\n"
+  "      <arg name=\"recordings\"   type=\"a(ia(sv))\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"Browse\">\n"
+  "      <arg name=\"folder\"       type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"offset\"       type=\"i\" direction=\"in\"/>\n"
+  "      <arg name=\"limit\"        type=\"i\" direction=\"in\"/>\n"
+  "      <arg name=\"sort\"         type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"folders\"      type=\"a(sit)\" direction=\"out\"/>\n"
+  "      <arg name=\"total\"        type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"recordings\"   type=\"a(ia(sv))\" direction=\"out\"/>\n"
+  "    </method>\n"
   "    <method name=\"Play\">\n"
   "      <arg name=\"number_or_path\" type=\"v\" direction=\"in\"/>\n"
   "      <arg name=\"begin\"          type=\"v\" direction=\"in\"/>\n"
   "      <arg name=\"replycode\"      type=\"i\" direction=\"out\"/>\n"
   "      <arg name=\"replymessage\"   type=\"s\" direction=\"out\"/>\n"
   "    </method>\n"
+  "    <method name=\"Rename\">\n"
+  "      <arg name=\"path\"           type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"newname\"        type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\"   type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"jobid\"          type=\"u\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"Move\">\n"
+  "      <arg name=\"path\"           type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"videodir\"       type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\"   type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"jobid\"          type=\"u\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"Delete\">\n"
+  "      <arg name=\"path\"           type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\"   type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"jobid\"          type=\"u\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"GetIndex\">\n"
+  "      <arg name=\"path\"           type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\"   type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"index\"          type=\"h\" direction=\"out\"/>\n"
+  "      <arg name=\"ispesrecording\" type=\"b\" direction=\"out\"/>\n"
+  "      <arg name=\"framespersecond\" type=\"d\" direction=\"out\"/>\n"
+  "      <arg name=\"frames\"         type=\"i\" direction=\"out\"/>\n"
+  "    </method>\n"
+  "    <method name=\"GetMarks\">\n"
+  "      <arg name=\"path\"           type=\"s\" direction=\"in\"/>\n"
+  "      <arg name=\"replycode\"      type=\"i\" direction=\"out\"/>\n"
+  "      <arg name=\"replymessage\"   type=\"s\" direction=\"out\"/>\n"
+  "      <arg name=\"marks\"          type=\"h\" direction=\"out\"/>\n"
+  "      <arg name=\"positions\"      type=\"a(iss)\" direction=\"out\"/>\n"
+  "    </method>\n"
   "    <method name=\"ChangeName\">\n"
   "      <arg name=\"number_or_path\" type=\"v\" direction=\"in\"/>\n"
   "      <arg name=\"newname\"        type=\"s\" direction=\"in\"/>\n"
@@ -598,6 +1524,8 @@ cDBusRecordingsConst::cDBusRecordingsConst(const char *NodeInfo)
 {
   AddMethod("Get", cDBusRecordingsHelper::Get);
   AddMethod("List", cDBusRecordingsHelper::List);
+  AddMethod("Browse", cDBusRecordingsHelper::Browse);
+  AddMethod("Search", cDBusRecordingsHelper::Search);
 #ifdef EXTRA_VIDEO_DIRECTORIES_PATCH
   AddMethod("ListExtraVideoDirectories", cDBusRecordingsHelper::ListExtraVideoDirectories);
 #endif
@@ -608,6 +1536,8 @@ cDBusRecordingsConst::cDBusRecordingsConst(void)
 {
   AddMethod("Get", cDBusRecordingsHelper::Get);
   AddMethod("List", cDBusRecordingsHelper::List);
+  AddMethod("Browse", cDBusRecordingsHelper::Browse);
+  AddMethod("Search", cDBusRecordingsHelper::Search);
 #ifdef EXTRA_VIDEO_DIRECTORIES_PATCH
   AddMethod("ListExtraVideoDirectories", cDBusRecordingsHelper::ListExtraVideoDirectories);
 #endif
@@ -617,12 +1547,24 @@ cDBusRecordingsConst::~cDBusRecordingsConst(void)
 {
 }
 
+void cDBusRecordingsConst::EmitSignal(const char *Signal, GVariant *Parameters)
+{
+  cDBusObject::EmitSignal("/Recordings", DBUS_VDR_RECORDING_INTERFACE, Signal, Parameters);
+}
+
 cDBusRecordings::cDBusRecordings(void)
 :cDBusRecordingsConst(cDBusRecordingsHelper::_xmlNodeInfo)
 {
   AddMethod("Update", cDBusRecordingsHelper::Update);
+  AddMethod("UpdateDirectory", cDBusRecordingsHelper::UpdateDirectory);
+  AddMethod("ScanStatistics", cDBusRecordingsHelper::ScanStatistics);
   AddMethod("Play", cDBusRecordingsHelper::Play);
   AddMethod("ChangeName", cDBusRecordingsHelper::ChangeName);
+  AddMethod("GetIndex", cDBusRecordingsHelper::GetIndex);
+  AddMethod("GetMarks", cDBusRecordingsHelper::GetMarks);
+  AddMethod("Rename", cDBusRecordingsHelper::Rename);
+  AddMethod("Move", cDBusRecordingsHelper::Move);
+  AddMethod("Delete", cDBusRecordingsHelper::Delete);
 #ifdef EXTRA_VIDEO_DIRECTORIES_PATCH
   AddMethod("AddExtraVideoDirectory", cDBusRecordingsHelper::AddExtraVideoDirectory);
   AddMethod("ClearExtraVideoDirectories", cDBusRecordingsHelper::ClearExtraVideoDirectories);
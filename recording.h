@@ -16,6 +16,9 @@ private:
 public:
   cDBusRecordingsConst(void);
   virtual ~cDBusRecordingsConst(void);
+
+  // emits the signal on all recordings objects
+  static void EmitSignal(const char *Signal, GVariant *Parameters);
 };
 
 class cDBusRecordings : public cDBusRecordingsConst
@@ -0,0 +1,334 @@
+#include "recordingcache.h"
+#include "recording.h"
+
+#include <sys/stat.h>
+
+#include <vdr/tools.h>
+
+
+#define RECORDINGCACHE_FILE          "recordings.cache"
+#define RECORDINGCACHE_CHECKINTERVAL 300 // seconds between checks of the modification times
+#define RECORDINGCACHE_SIGNALBATCH   100 // max. number of paths per "Refreshed" signal
+
+typedef struct {
+  time_t mtime;    // 0 if the values are not yet computed
+  int    sizeMB;
+  int    numFrames;
+  int    length;
+  bool   isPes;
+  double fps;
+  bool   queued;
+} tDBusRecordingCacheEntry;
+
+
+cMutex               cDBusRecordingCache::_cacheMutex;
+cDBusRecordingCache *cDBusRecordingCache::_cache = NULL;
+
+cDBusRecordingCache::cDBusRecordingCache(const char *Directory)
+{
+  _entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  _queue = g_queue_new();
+  _generation = 0;
+  _dirty = false;
+  _filename = AddDirectory(Directory, RECORDINGCACHE_FILE);
+  Load();
+  SetDescription("dbus2vdr: recording cache");
+  Start();
+}
+
+cDBusRecordingCache::~cDBusRecordingCache(void)
+{
+  _mutex.Lock();
+  _cond.Broadcast();
+  _mutex.Unlock();
+  Cancel(10);
+  Save();
+  g_queue_free_full(_queue, g_free);
+  g_hash_table_destroy(_entries);
+}
+
+void  cDBusRecordingCache::Init(const char *Directory)
+{
+  cMutexLock MutexLock(&_cacheMutex);
+  if (_cache == NULL)
+     _cache = new cDBusRecordingCache(Directory);
+}
+
+void  cDBusRecordingCache::Shutdown(void)
+{
+  cMutexLock MutexLock(&_cacheMutex);
+  if (_cache != NULL) {
+     delete _cache;
+     _cache = NULL;
+     }
+}
+
+bool  cDBusRecordingCache::Get(const cRecording *Recording, int &SizeMB, int &NumFrames, int &LengthInSeconds, bool Compute)
+{
+  // the values of a recording which is still being recorded are outdated as soon
+  // as they are cached, so the modification time is checked on every access
+  bool inProgress = ((Recording->IsInUse() & ruTimer) != 0);
+  time_t mtime = 0;
+  if (inProgress)
+     GetModificationTime(Recording->FileName(), Recording->IsPesRecording(), mtime);
+
+  {
+  cMutexLock CacheLock(&_cacheMutex);
+  if (_cache == NULL) {
+     if (!Compute) {
+        SizeMB = -1;
+        NumFrames = -1;
+        LengthInSeconds = -1;
+        return false;
+        }
+     SizeMB = Recording->FileSizeMB();
+     NumFrames = Recording->NumFrames();
+     LengthInSeconds = Recording->LengthInSeconds();
+     return true;
+     }
+
+  cMutexLock MutexLock(&_cache->_mutex);
+  tDBusRecordingCacheEntry *entry = (tDBusRecordingCacheEntry*)g_hash_table_lookup(_cache->_entries, Recording->FileName());
+  if ((entry != NULL) && (entry->mtime != 0)) {
+     SizeMB = entry->sizeMB;
+     NumFrames = entry->numFrames;
+     LengthInSeconds = entry->length;
+     if (!inProgress || (entry->mtime == mtime))
+        return true;
+     }
+  else {
+     SizeMB = -1;
+     NumFrames = -1;
+     LengthInSeconds = -1;
+     }
+
+  if (entry == NULL) {
+     entry = g_new0(tDBusRecordingCacheEntry, 1);
+     entry->isPes = Recording->IsPesRecording();
+     entry->fps = Recording->FramesPerSecond();
+     g_hash_table_insert(_cache->_entries, g_strdup(Recording->FileName()), entry);
+     }
+  if (!entry->queued) {
+     entry->queued = true;
+     g_queue_push_tail(_cache->_queue, g_strdup(Recording->FileName()));
+     _cache->_cond.Broadcast();
+     }
+  }
+
+  // the size is refreshed in the background, but the length
+  // is only a stat of the index file
+  if (inProgress) {
+     NumFrames = cIndexFile::GetLength(Recording->FileName(), Recording->IsPesRecording());
+     LengthInSeconds = ((NumFrames >= 0) && (Recording->FramesPerSecond() > 0)) ? int(NumFrames / Recording->FramesPerSecond()) : -1;
+     }
+  return false;
+}
+
+guint  cDBusRecordingCache::Generation(void)
+{
+  cMutexLock CacheLock(&_cacheMutex);
+  if (_cache == NULL)
+     return 0;
+  cMutexLock MutexLock(&_cache->_mutex);
+  return _cache->_generation;
+}
+
+bool  cDBusRecordingCache::GetModificationTime(const char *Path, bool IsPesRecording, time_t &ModificationTime)
+{
+  // the index file is written continuously while recording,
+  // the directory changes if files are added or removed
+  struct stat st;
+  if (stat(Path, &st) != 0)
+     return false;
+  ModificationTime = st.st_mtime;
+  cString index = AddDirectory(Path, IsPesRecording ? "index.vdr" : "index");
+  if ((stat(*index, &st) == 0) && (st.st_mtime > ModificationTime))
+     ModificationTime = st.st_mtime;
+  return true;
+}
+
+void  cDBusRecordingCache::Load(void)
+{
+  FILE *f = fopen(*_filename, "r");
+  if (f == NULL)
+     return;
+
+  int count = 0;
+  cReadLine r;
+  char *line;
+  while ((line = r.Read(f)) != NULL) {
+        long mtime = 0;
+        int isPes = 0;
+        int pos = 0;
+        tDBusRecordingCacheEntry *entry = g_new0(tDBusRecordingCacheEntry, 1);
+        if ((sscanf(line, "%ld %d %d %d %d %lf %n", &mtime, &entry->sizeMB, &entry->numFrames, &entry->length, &isPes, &entry->fps, &pos) >= 6) && (pos > 0) && (line[pos] != 0)) {
+           entry->mtime = mtime;
+           entry->isPes = (isPes != 0);
+           g_hash_table_insert(_entries, g_strdup(line + pos), entry);
+           count++;
+           }
+        else
+           g_free(entry);
+        }
+  fclose(f);
+  isyslog("dbus2vdr: loaded %d entries from %s", count, *_filename);
+}
+
+void  cDBusRecordingCache::Save(void)
+{
+  cMutexLock MutexLock(&_mutex);
+  if (!_dirty)
+     return;
+
+  cString tmpname = cString::sprintf("%s.tmp", *_filename);
+  FILE *f = fopen(*tmpname, "w");
+  if (f == NULL) {
+     LOG_ERROR_STR(*tmpname);
+     return;
+     }
+
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  g_hash_table_iter_init(&iter, _entries);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+        tDBusRecordingCacheEntry *entry = (tDBusRecordingCacheEntry*)value;
+        if (entry->mtime != 0)
+           fprintf(f, "%ld %d %d %d %d %.3f %s\n", (long)entry->mtime, entry->sizeMB, entry->numFrames, entry->length, entry->isPes ? 1 : 0, entry->fps, (const char*)key);
+        }
+  if ((fclose(f) == 0) && (rename(*tmpname, *_filename) == 0))
+     _dirty = false;
+  else
+     LOG_ERROR_STR(*_filename);
+}
+
+void  cDBusRecordingCache::Revalidate(void)
+{
+  // stat without holding the mutex, the video directory may be on a slow network drive
+  cStringList paths;
+  cVector<int> isPes;
+  cVector<time_t> mtimes;
+  _mutex.Lock();
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  g_hash_table_iter_init(&iter, _entries);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+        tDBusRecordingCacheEntry *entry = (tDBusRecordingCacheEntry*)value;
+        if ((entry->mtime != 0) && !entry->queued) {
+           paths.Append(strdup((const char*)key));
+           isPes.Append(entry->isPes ? 1 : 0);
+           mtimes.Append(entry->mtime);
+           }
+        }
+  _mutex.Unlock();
+
+  int queued = 0;
+  int removed = 0;
+  for (int i = 0; Running() && (i < paths.Size()); i++) {
+      time_t mtime = 0;
+      bool exists = GetModificationTime(paths[i], isPes[i] != 0, mtime);
+      if (exists && (mtime == mtimes[i]))
+         continue;
+      cMutexLock MutexLock(&_mutex);
+      tDBusRecordingCacheEntry *entry = (tDBusRecordingCacheEntry*)g_hash_table_lookup(_entries, paths[i]);
+      if ((entry == NULL) || entry->queued)
+         continue;
+      if (!exists) {
+         g_hash_table_remove(_entries, paths[i]);
+         _dirty = true;
+         removed++;
+         }
+      else {
+         entry->queued = true;
+         g_queue_push_tail(_queue, g_strdup(paths[i]));
+         queued++;
+         }
+      }
+  if ((queued > 0) || (removed > 0))
+     d4syslog("dbus2vdr: recording cache: %d changed, %d removed of %d recordings", queued, removed, paths.Size());
+}
+
+void  cDBusRecordingCache::EmitRefreshed(GVariantBuilder *Paths, int &Count)
+{
+  if (Count > 0) {
+     // once per batch, so the folder tree of Browse isn't rebuilt for every recording
+     _mutex.Lock();
+     _generation++;
+     _mutex.Unlock();
+     cDBusRecordingsConst::EmitSignal("Refreshed", g_variant_new("(as)", Paths));
+     }
+  else
+     g_variant_builder_clear(Paths);
+  g_variant_builder_init(Paths, G_VARIANT_TYPE("as"));
+  Count = 0;
+}
+
+void  cDBusRecordingCache::Action(void)
+{
+  GVariantBuilder refreshed;
+  g_variant_builder_init(&refreshed, G_VARIANT_TYPE("as"));
+  int count = 0;
+  // the recordings may have been cut, edited or deleted while vdr wasn't running,
+  // so the loaded entries are checked before the first queued one is computed
+  Revalidate();
+  time_t lastCheck = time(NULL);
+
+  while (Running()) {
+        char *path = NULL;
+        bool isPes = false;
+        double fps = 0;
+        _mutex.Lock();
+        path = (char*)g_queue_pop_head(_queue);
+        if (path != NULL) {
+           tDBusRecordingCacheEntry *entry = (tDBusRecordingCacheEntry*)g_hash_table_lookup(_entries, path);
+           if (entry != NULL) {
+              isPes = entry->isPes;
+              fps = entry->fps;
+              }
+           }
+        _mutex.Unlock();
+
+        if (path == NULL) {
+           EmitRefreshed(&refreshed, count);
+           Save();
+           if (time(NULL) - lastCheck >= RECORDINGCACHE_CHECKINTERVAL) {
+              Revalidate();
+              lastCheck = time(NULL);
+              continue;
+              }
+           cMutexLock MutexLock(&_mutex);
+           if (Running() && g_queue_is_empty(_queue))
+              _cond.TimedWait(_mutex, 1000);
+           continue;
+           }
+
+        time_t mtime = 0;
+        if (GetModificationTime(path, isPes, mtime)) {
+           int sizeMB = DirSizeMB(path);
+           int numFrames = cIndexFile::GetLength(path, isPes);
+           int length = ((numFrames >= 0) && (fps > 0)) ? int(numFrames / fps) : -1;
+
+           cMutexLock MutexLock(&_mutex);
+           tDBusRecordingCacheEntry *entry = (tDBusRecordingCacheEntry*)g_hash_table_lookup(_entries, path);
+           if (entry != NULL) {
+              entry->mtime = mtime;
+              entry->sizeMB = sizeMB;
+              entry->numFrames = numFrames;
+              entry->length = length;
+              entry->queued = false;
+              _dirty = true;
+              }
+           }
+        else {
+           cMutexLock MutexLock(&_mutex);
+           g_hash_table_remove(_entries, path);
+           }
+
+        g_variant_builder_add(&refreshed, "s", path);
+        if (++count >= RECORDINGCACHE_SIGNALBATCH)
+           EmitRefreshed(&refreshed, count);
+        g_free(path);
+        }
+  g_variant_builder_clear(&refreshed);
+}
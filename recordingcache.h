@@ -0,0 +1,54 @@
+#ifndef __DBUS2VDR_RECORDINGCACHE_H
+#define __DBUS2VDR_RECORDINGCACHE_H
+
+#include <gio/gio.h>
+
+#include <vdr/recording.h>
+#include <vdr/thread.h>
+
+
+// computes size and length of recordings in a background thread,
+// the values are stored with the modification time of the recording
+// in a file in the config directory of the plugin
+class cDBusRecordingCache : public cThread
+{
+private:
+  static cMutex               _cacheMutex;
+  static cDBusRecordingCache *_cache;
+
+  cMutex      _mutex;
+  cCondVar    _cond;
+  GHashTable *_entries;
+  GQueue     *_queue;
+  guint       _generation;
+  bool        _dirty;
+  cString     _filename;
+
+  cDBusRecordingCache(const char *Directory);
+
+  static bool GetModificationTime(const char *Path, bool IsPesRecording, time_t &ModificationTime);
+
+  void Load(void);
+  void Save(void);
+  void Revalidate(void);
+  void EmitRefreshed(GVariantBuilder *Paths, int &Count);
+
+protected:
+  virtual void Action(void);
+
+public:
+  virtual ~cDBusRecordingCache(void);
+
+  static void Init(const char *Directory);
+  static void Shutdown(void);
+
+  // returns false if the values are not yet known, then they are set to -1
+  // and the recording is queued for the background thread, for a recording
+  // in progress the old size and the current length are returned,
+  // without the background thread they are computed here unless Compute is false
+  static bool Get(const cRecording *Recording, int &SizeMB, int &NumFrames, int &LengthInSeconds, bool Compute = true);
+  // is incremented with every "Refreshed" signal, i.e. once per batch of changed values
+  static guint Generation(void);
+};
+
+#endif
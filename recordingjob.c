@@ -0,0 +1,280 @@
+#include "recordingjob.h"
+#include "recording.h"
+#include "recordingscanner.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <vdr/recording.h>
+
+
+// like in vdr's recording.c
+#define RECEXT                ".rec"
+#define DELEXT                ".del"
+
+#define RECORDINGJOB_THREADS  2       // max. number of jobs per filesystem
+#define RECORDINGJOB_BUFSIZE  1048576 // for copying between filesystems
+
+class cDBusRecordingJob
+{
+public:
+  guint32 id;
+  bool    remove;      // delete the recording instead of moving it
+  cString fileName;
+  cString newFileName;
+  guint64 total;       // bytes to copy
+  guint64 done;
+  int     percent;
+
+  cDBusRecordingJob(guint32 Id, bool Remove, const char *FileName, const char *NewFileName)
+   :id(Id),remove(Remove),fileName(FileName),newFileName(NewFileName),total(0),done(0),percent(-1) {};
+};
+
+
+cMutex      cDBusRecordingJobs::_mutex;
+GHashTable *cDBusRecordingJobs::_pools = NULL;
+guint32     cDBusRecordingJobs::_nextId = 1;
+gint        cDBusRecordingJobs::_shutdown = 0;
+
+void  cDBusRecordingJobs::FreePool(gpointer Data)
+{
+  g_thread_pool_free((GThreadPool*)Data, FALSE, TRUE);
+}
+
+guint32  cDBusRecordingJobs::PushJob(cDBusRecordingJob *Job, dev_t Device, cString &Error)
+{
+  // with _mutex locked
+  if (_pools == NULL)
+     _pools = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, FreePool);
+  gint64 key = Device;
+  GThreadPool *pool = (GThreadPool*)g_hash_table_lookup(_pools, &key);
+  if (pool == NULL) {
+     GError *err = NULL;
+     pool = g_thread_pool_new(RunJob, NULL, RECORDINGJOB_THREADS, FALSE, &err);
+     if (pool == NULL) {
+        Error = cString::sprintf("can't create thread pool: %s", err->message);
+        g_error_free(err);
+        delete Job;
+        return 0;
+        }
+     g_hash_table_insert(_pools, g_memdup(&key, sizeof(key)), pool);
+     }
+  Job->id = _nextId++;
+  if (_nextId == 0)
+     _nextId = 1;
+  guint32 id = Job->id;
+  g_thread_pool_push(pool, Job, NULL);
+  return id;
+}
+
+bool  cDBusRecordingJobs::IsInVideoDirectory(const char *FileName)
+{
+  // the name of a recording may contain "..", but not as a directory of its own
+  if ((strstr(FileName, "/../") != NULL) || endswith(FileName, "/.."))
+     return false;
+  cStringList dirs;
+  cDBusRecordingScanner::GetDirectories(dirs);
+  for (int i = 0; i < dirs.Size(); i++) {
+      int len = strlen(dirs[i]);
+      while ((len > 1) && (dirs[i][len - 1] == '/'))
+            len--;
+      if ((strncmp(FileName, dirs[i], len) == 0) && (FileName[len] == '/') && (FileName[len + 1] != 0))
+         return true;
+      }
+  return false;
+}
+
+guint32 cDBusRecordingJobs::Move(const char *FileName, const char *NewFileName, cString &Error)
+{
+  struct stat st;
+  if (stat(FileName, &st) != 0) {
+     Error = cString::sprintf("can't access %s", FileName);
+     return 0;
+     }
+  if (access(NewFileName, F_OK) == 0) {
+     Error = cString::sprintf("%s already exists", NewFileName);
+     return 0;
+     }
+  if (!IsInVideoDirectory(NewFileName)) {
+     Error = cString::sprintf("%s is not in a video directory", NewFileName);
+     return 0;
+     }
+
+  cMutexLock MutexLock(&_mutex);
+  if (g_atomic_int_get(&_shutdown)) {
+     Error = "shutting down";
+     return 0;
+     }
+  guint32 id = PushJob(new cDBusRecordingJob(0, false, FileName, NewFileName), st.st_dev, Error);
+  if (id > 0)
+     isyslog("dbus2vdr: job %u: moving recording %s to %s", id, FileName, NewFileName);
+  return id;
+}
+
+guint32 cDBusRecordingJobs::Delete(const char *FileName, cString &Error)
+{
+  struct stat st;
+  if (stat(FileName, &st) != 0) {
+     Error = cString::sprintf("can't access %s", FileName);
+     return 0;
+     }
+  // like cRecording::Delete, vdr removes the directory later
+  if (!endswith(FileName, RECEXT)) {
+     Error = cString::sprintf("%s is no recording", FileName);
+     return 0;
+     }
+  cString newFileName = cString::sprintf("%.*s%s", (int)(strlen(FileName) - strlen(RECEXT)), FileName, DELEXT);
+
+  cMutexLock MutexLock(&_mutex);
+  if (g_atomic_int_get(&_shutdown)) {
+     Error = "shutting down";
+     return 0;
+     }
+  guint32 id = PushJob(new cDBusRecordingJob(0, true, FileName, *newFileName), st.st_dev, Error);
+  if (id > 0)
+     isyslog("dbus2vdr: job %u: deleting recording %s", id, FileName);
+  return id;
+}
+
+void  cDBusRecordingJobs::Shutdown(void)
+{
+  GHashTable *pools = NULL;
+  _mutex.Lock();
+  g_atomic_int_set(&_shutdown, 1);
+  pools = _pools;
+  _pools = NULL;
+  _mutex.Unlock();
+  // waits for the threads of all pools
+  if (pools != NULL)
+     g_hash_table_destroy(pools);
+}
+
+void  cDBusRecordingJobs::SetProgress(cDBusRecordingJob *Job, int Percent)
+{
+  if (Percent == Job->percent)
+     return;
+  Job->percent = Percent;
+  cDBusRecordingsConst::EmitSignal("JobProgress", g_variant_new("(ui)", Job->id, Percent));
+}
+
+bool  cDBusRecordingJobs::CopyRecording(cDBusRecordingJob *Job, cString &Error)
+{
+  // a recording directory contains only files
+  cStringList files;
+  cReadDir d(*Job->fileName);
+  struct dirent *e;
+  while ((e = d.Next()) != NULL) {
+        cString file = AddDirectory(*Job->fileName, e->d_name);
+        struct stat st;
+        if ((stat(*file, &st) == 0) && S_ISREG(st.st_mode)) {
+           files.Append(strdup(e->d_name));
+           Job->total += st.st_size;
+           }
+        }
+
+  if (!MakeDirs(*Job->newFileName, true)) {
+     Error = cString::sprintf("can't create %s", *Job->newFileName);
+     return false;
+     }
+
+  bool ok = true;
+  uchar *buffer = MALLOC(uchar, RECORDINGJOB_BUFSIZE);
+  for (int i = 0; ok && (i < files.Size()); i++) {
+      cString from = AddDirectory(*Job->fileName, files[i]);
+      cString to = AddDirectory(*Job->newFileName, files[i]);
+      int in = open(*from, O_RDONLY | O_CLOEXEC);
+      int out = open(*to, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, DEFFILEMODE);
+      if ((in < 0) || (out < 0)) {
+         Error = cString::sprintf("can't copy %s to %s", *from, *to);
+         ok = false;
+         }
+      while (ok) {
+            if (g_atomic_int_get(&_shutdown)) {
+               Error = "aborted";
+               ok = false;
+               break;
+               }
+            ssize_t r = safe_read(in, buffer, RECORDINGJOB_BUFSIZE);
+            if (r == 0)
+               break;
+            if ((r < 0) || (safe_write(out, buffer, r) != r)) {
+               Error = cString::sprintf("error while copying %s to %s: %s", *from, *to, strerror(errno));
+               ok = false;
+               break;
+               }
+            Job->done += r;
+            if (Job->total > 0)
+               SetProgress(Job, (int)(Job->done * 100 / Job->total));
+            }
+      if (in >= 0)
+         close(in);
+      if ((out >= 0) && (close(out) != 0) && ok) {
+         Error = cString::sprintf("error while copying %s to %s: %s", *from, *to, strerror(errno));
+         ok = false;
+         }
+      }
+  free(buffer);
+
+  if (ok)
+     RemoveFileOrDir(*Job->fileName);
+  else
+     RemoveFileOrDir(*Job->newFileName);
+  return ok;
+}
+
+void  cDBusRecordingJobs::RunJob(gpointer Data, gpointer UserData)
+{
+  cDBusRecordingJob *job = (cDBusRecordingJob*)Data;
+  if (g_atomic_int_get(&_shutdown)) {
+     delete job;
+     return;
+     }
+
+  int replyCode = 250;
+  cString error;
+  SetProgress(job, 0);
+  if (job->remove) {
+     // like cRecording::Delete, a recording with the same name deleted before is removed
+     if (access(*job->newFileName, F_OK) == 0) {
+        isyslog("dbus2vdr: job %u: removing recording %s", job->id, *job->newFileName);
+        RemoveFileOrDir(*job->newFileName);
+        }
+     if (rename(*job->fileName, *job->newFileName) != 0)
+        error = cString::sprintf("can't rename %s: %s", *job->fileName, strerror(errno));
+     }
+  else if (!MakeDirs(*job->newFileName, false))
+     error = cString::sprintf("can't create directory for %s", *job->newFileName);
+  else if (rename(*job->fileName, *job->newFileName) != 0) {
+     if (errno == EXDEV)
+        CopyRecording(job, error);
+     else
+        error = cString::sprintf("can't rename %s: %s", *job->fileName, strerror(errno));
+     }
+
+  if (*error == NULL) {
+#if VDRVERSNUM > 20300
+     LOCK_RECORDINGS_WRITE;
+     cRecordings *recs = Recordings;
+#else
+     cThreadLock RecordingsLock(&Recordings);
+     cRecordings *recs = &Recordings;
+#endif
+     recs->DelByName(*job->fileName);
+     if (!job->remove)
+        recs->AddByName(*job->newFileName);
+     }
+  else {
+     replyCode = 554;
+     esyslog("dbus2vdr: job %u: %s", job->id, *error);
+     }
+
+  if (*error == NULL) {
+     SetProgress(job, 100);
+     isyslog("dbus2vdr: job %u finished", job->id);
+     error = job->remove ? cString::sprintf("Recording \"%s\" deleted", *job->fileName)
+                         : cString::sprintf("Recording \"%s\" moved to \"%s\"", *job->fileName, *job->newFileName);
+     }
+  cDBusRecordingsConst::EmitSignal("JobFinished", g_variant_new("(uis)", job->id, replyCode, *error));
+  delete job;
+}
@@ -0,0 +1,41 @@
+#ifndef __DBUS2VDR_RECORDINGJOB_H
+#define __DBUS2VDR_RECORDINGJOB_H
+
+#include <gio/gio.h>
+#include <sys/types.h>
+
+#include <vdr/thread.h>
+#include <vdr/tools.h>
+
+
+class cDBusRecordingJob;
+
+// moves and deletes recordings in the background, the recordings list
+// is only locked for removing and adding the recording at the end
+class cDBusRecordingJobs
+{
+private:
+  static cMutex      _mutex;
+  static GHashTable *_pools; // one pool per filesystem
+  static guint32     _nextId;
+  static gint        _shutdown; // read without _mutex by the jobs, use g_atomic_int_*
+
+  static void    FreePool(gpointer Data);
+  static bool    IsInVideoDirectory(const char *FileName);
+  static guint32 PushJob(cDBusRecordingJob *Job, dev_t Device, cString &Error);
+  static void    RunJob(gpointer Data, gpointer UserData);
+  static bool    CopyRecording(cDBusRecordingJob *Job, cString &Error);
+  static void    SetProgress(cDBusRecordingJob *Job, int Percent);
+
+public:
+  // the returned id is used in the signals "JobProgress" and "JobFinished",
+  // on error 0 is returned
+  // NewFileName must be in the video directory or one of the extra video directories
+  static guint32 Move(const char *FileName, const char *NewFileName, cString &Error);
+  static guint32 Delete(const char *FileName, cString &Error);
+
+  // waits for running jobs, queued jobs are dropped
+  static void  Shutdown(void);
+};
+
+#endif
@@ -0,0 +1,217 @@
+#include "recordingscanner.h"
+
+#include <sys/stat.h>
+
+#include <vdr/recording.h>
+#include <vdr/videodir.h>
+
+
+// like in vdr's recording.c
+#define RECEXT                   ".rec"
+#define MAX_LINK_LEVEL           6
+
+#define RECORDINGSCANNER_THREADS 4 // max. number of directories scanned in parallel
+
+typedef struct {
+  int     recordings;
+  int     added;
+  int     removed;
+  guint64 duration;  // ms
+  time_t  time;      // of the last finished scan
+  bool    scanning;
+} tDBusScanStatistics;
+
+
+cMutex       cDBusRecordingScanner::_mutex;
+GThreadPool *cDBusRecordingScanner::_pool = NULL;
+GHashTable  *cDBusRecordingScanner::_statistics = NULL;
+gint         cDBusRecordingScanner::_shutdown = 0;
+
+void  cDBusRecordingScanner::GetDirectories(cStringList &Directories)
+{
+#if VDRVERSNUM > 20101
+  Directories.Append(strdup(cVideoDirectory::Name()));
+#else
+  Directories.Append(strdup(VideoDirectory));
+#endif
+#ifdef EXTRA_VIDEO_DIRECTORIES_PATCH
+  if (LockExtraVideoDirectories(true)) {
+     for (int i = 0; i < ExtraVideoDirectories.Size(); i++)
+         Directories.Append(strdup(ExtraVideoDirectories.At(i)));
+     UnlockExtraVideoDirectories();
+     }
+#endif
+}
+
+bool  cDBusRecordingScanner::Scan(const char *Directory, cString &Error)
+{
+  cMutexLock MutexLock(&_mutex);
+  if (g_atomic_int_get(&_shutdown)) {
+     Error = "shutting down";
+     return false;
+     }
+  if (_pool == NULL) {
+     GError *err = NULL;
+     _pool = g_thread_pool_new(RunScan, NULL, RECORDINGSCANNER_THREADS, FALSE, &err);
+     if (_pool == NULL) {
+        Error = cString::sprintf("can't create thread pool: %s", err->message);
+        g_error_free(err);
+        return false;
+        }
+     _statistics = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+     }
+
+  tDBusScanStatistics *stat = (tDBusScanStatistics*)g_hash_table_lookup(_statistics, Directory);
+  if (stat == NULL) {
+     stat = g_new0(tDBusScanStatistics, 1);
+     g_hash_table_insert(_statistics, g_strdup(Directory), stat);
+     }
+  else if (stat->scanning) {
+     Error = cString::sprintf("%s is already being scanned", Directory);
+     return false;
+     }
+  stat->scanning = true;
+  g_thread_pool_push(_pool, g_strdup(Directory), NULL);
+  return true;
+}
+
+void  cDBusRecordingScanner::GetStatistics(GVariantBuilder *Array)
+{
+  cMutexLock MutexLock(&_mutex);
+  if (_statistics == NULL)
+     return;
+
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  g_hash_table_iter_init(&iter, _statistics);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+        tDBusScanStatistics *stat = (tDBusScanStatistics*)value;
+        g_variant_builder_add(Array, "(siiitt)", (const char*)key, stat->recordings, stat->added, stat->removed, stat->duration, (guint64)stat->time);
+        }
+}
+
+void  cDBusRecordingScanner::Shutdown(void)
+{
+  GThreadPool *pool = NULL;
+  _mutex.Lock();
+  g_atomic_int_set(&_shutdown, 1);
+  pool = _pool;
+  _pool = NULL;
+  _mutex.Unlock();
+  // running scans are aborted, queued ones are skipped
+  if (pool != NULL)
+     g_thread_pool_free(pool, FALSE, TRUE);
+  _mutex.Lock();
+  if (_statistics != NULL) {
+     g_hash_table_destroy(_statistics);
+     _statistics = NULL;
+     }
+  _mutex.Unlock();
+}
+
+void  cDBusRecordingScanner::ScanDirectory(const char *DirName, int LinkLevel, GHashTable *Found)
+{
+  // like cRecordings::ScanVideoDir
+  cReadDir d(DirName);
+  struct dirent *e;
+  while (!g_atomic_int_get(&_shutdown) && ((e = d.Next()) != NULL)) {
+        cString buffer = AddDirectory(DirName, e->d_name);
+        struct stat st;
+        if (lstat(*buffer, &st) != 0)
+           continue;
+        int Link = 0;
+        if (S_ISLNK(st.st_mode)) {
+           if (LinkLevel > MAX_LINK_LEVEL) {
+              isyslog("dbus2vdr: max link level exceeded - not scanning %s", *buffer);
+              continue;
+              }
+           Link = 1;
+           if (stat(*buffer, &st) != 0)
+              continue;
+           }
+        if (S_ISDIR(st.st_mode)) {
+           if (endswith(*buffer, RECEXT))
+              g_hash_table_add(Found, g_strdup(*buffer));
+           else
+              ScanDirectory(*buffer, LinkLevel + Link, Found);
+           }
+        }
+}
+
+void  cDBusRecordingScanner::Merge(const char *Directory, GHashTable *Found, int &Added, int &Removed)
+{
+  // a recording belongs to the longest matching directory
+  cStringList dirs;
+  GetDirectories(dirs);
+  int len = strlen(Directory);
+
+#if VDRVERSNUM > 20300
+  LOCK_RECORDINGS_WRITE;
+  cRecordings *recs = Recordings;
+#else
+  cThreadLock RecordingsLock(&Recordings);
+  cRecordings *recs = &Recordings;
+#endif
+  cStringList vanished;
+  for (const cRecording *r = recs->First(); r; r = recs->Next(r)) {
+      const char *fileName = r->FileName();
+      if ((strncmp(fileName, Directory, len) != 0) || (fileName[len] != '/'))
+         continue;
+      bool other = false;
+      for (int i = 0; !other && (i < dirs.Size()); i++) {
+          int l = strlen(dirs[i]);
+          other = (l > len) && (strncmp(fileName, dirs[i], l) == 0) && (fileName[l] == '/');
+          }
+      if (other)
+         continue;
+      if (!g_hash_table_remove(Found, fileName))
+         vanished.Append(strdup(fileName));
+      }
+
+  // only new recordings are left in Found
+  for (int i = 0; i < vanished.Size(); i++)
+      recs->DelByName(vanished[i]);
+  GHashTableIter iter;
+  gpointer key;
+  g_hash_table_iter_init(&iter, Found);
+  while (g_hash_table_iter_next(&iter, &key, NULL))
+        recs->AddByName((const char*)key, false);
+  Added = g_hash_table_size(Found);
+  Removed = vanished.Size();
+  if ((Added > 0) || (Removed > 0))
+     recs->TouchUpdate();
+}
+
+void  cDBusRecordingScanner::RunScan(gpointer Data, gpointer UserData)
+{
+  char *dir = (char*)Data;
+  int recordings = 0;
+  int added = 0;
+  int removed = 0;
+  cTimeMs timer;
+  if (!g_atomic_int_get(&_shutdown)) {
+     GHashTable *found = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+     ScanDirectory(dir, 0, found);
+     recordings = g_hash_table_size(found);
+     if (!g_atomic_int_get(&_shutdown))
+        Merge(dir, found, added, removed);
+     g_hash_table_destroy(found);
+     }
+  uint64_t duration = timer.Elapsed();
+
+  cMutexLock MutexLock(&_mutex);
+  tDBusScanStatistics *stat = (_statistics != NULL) ? (tDBusScanStatistics*)g_hash_table_lookup(_statistics, dir) : NULL;
+  if (stat != NULL) {
+     if (!g_atomic_int_get(&_shutdown)) {
+        stat->recordings = recordings;
+        stat->added = added;
+        stat->removed = removed;
+        stat->duration = duration;
+        stat->time = time(NULL);
+        }
+     stat->scanning = false;
+     }
+  isyslog("dbus2vdr: scanned %s in %llu ms: %d recordings, %d added, %d removed", dir, (unsigned long long)duration, recordings, added, removed);
+  g_free(dir);
+}
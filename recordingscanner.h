@@ -0,0 +1,34 @@
+#ifndef __DBUS2VDR_RECORDINGSCANNER_H
+#define __DBUS2VDR_RECORDINGSCANNER_H
+
+#include <gio/gio.h>
+
+#include <vdr/thread.h>
+#include <vdr/tools.h>
+
+
+// scans the video directories in parallel, one job per directory,
+// and adds new and removes vanished recordings from vdr's list
+class cDBusRecordingScanner
+{
+private:
+  static cMutex       _mutex;
+  static GThreadPool *_pool;
+  static GHashTable  *_statistics; // directory -> tDBusScanStatistics
+  static gint         _shutdown; // read without _mutex by the scans, use g_atomic_int_*
+
+  static void  ScanDirectory(const char *DirName, int LinkLevel, GHashTable *Found);
+  static void  RunScan(gpointer Data, gpointer UserData);
+  static void  Merge(const char *Directory, GHashTable *Found, int &Added, int &Removed);
+
+public:
+  // the main video directory and the extra video directories
+  static void  GetDirectories(cStringList &Directories);
+  // returns false if the directory is already being scanned
+  static bool  Scan(const char *Directory, cString &Error);
+  // adds the last scan of every directory to an "a(siiitt)" array
+  static void  GetStatistics(GVariantBuilder *Array);
+  static void  Shutdown(void);
+};
+
+#endif
@@ -7,6 +7,151 @@
 #include <vdr/remote.h>
 
 
+#define MACRO_MAXDELAY 60000 // ms after one key
+
+
+class cDBusRemoteMacro : public cListObject
+{
+public:
+  guint32        id;
+  cVector<eKeys> keys;
+  cVector<int>   delays; // ms after the key
+
+  cDBusRemoteMacro(void) :id(0) {};
+};
+
+// plays the macros one after the other, the keys are timed from the start
+// of the macro, so the time needed to put a key doesn't add up
+class cDBusRemoteMacroPlayer : public cThread
+{
+private:
+  cMutex                  _mutex;
+  cCondVar                _wakeup;
+  cList<cDBusRemoteMacro> _queue;
+  guint32                 _nextId;
+  guint32                 _playing;  // id of the playing macro
+  bool                    _cancel;   // the playing macro
+  bool                    _stop;
+
+  // with _mutex locked, returns false if the macro is cancelled
+  bool WaitUntil(uint64_t Due)
+  {
+    while (!_stop && !_cancel) {
+          uint64_t now = cTimeMs::Now();
+          if (now >= Due)
+             return true;
+          _wakeup.TimedWait(_mutex, (int)(Due - now));
+          }
+    return false;
+  };
+
+protected:
+  virtual void Action(void)
+  {
+    _mutex.Lock();
+    while (!_stop) {
+          cDBusRemoteMacro *macro = _queue.First();
+          if (macro == NULL) {
+             _wakeup.Wait(_mutex);
+             continue;
+             }
+          _queue.Del(macro, false);
+          _playing = macro->id;
+          _cancel = false;
+
+          int replyCode = 250;
+          cString replyMessage = "macro finished";
+          uint64_t due = cTimeMs::Now();
+          for (int i = 0; i < macro->keys.Size(); i++) {
+              if (!WaitUntil(due)) {
+                 replyCode = 550;
+                 replyMessage = cString::sprintf("macro cancelled after %d of %d keys", i, macro->keys.Size());
+                 break;
+                 }
+              if (!cRemote::Put(macro->keys[i])) {
+                 replyCode = 554;
+                 replyMessage = cString::sprintf("key %s not accepted", cKey::ToString(macro->keys[i]));
+                 break;
+                 }
+              due += macro->delays[i];
+              }
+          // the delay after the last key is kept, too
+          if ((replyCode == 250) && !WaitUntil(due)) {
+             replyCode = 550;
+             replyMessage = "macro cancelled after the last key";
+             }
+          _playing = 0;
+          _mutex.Unlock();
+
+          if (replyCode != 250)
+             isyslog("dbus2vdr: macro %u: %s", macro->id, *replyMessage);
+          cDBusRemote::EmitSignal("MacroFinished", g_variant_new("(uis)", macro->id, replyCode, *replyMessage));
+          delete macro;
+          _mutex.Lock();
+          }
+    _mutex.Unlock();
+  };
+
+public:
+  cDBusRemoteMacroPlayer(void)
+   :cThread("dbus2vdr: remote macros")
+   ,_nextId(1)
+   ,_playing(0)
+   ,_cancel(false)
+   ,_stop(false)
+  {
+  };
+
+  virtual ~cDBusRemoteMacroPlayer(void)
+  {
+    _mutex.Lock();
+    _stop = true;
+    _wakeup.Broadcast();
+    _mutex.Unlock();
+    Cancel(3);
+  };
+
+  guint32 Play(cDBusRemoteMacro *Macro)
+  {
+    cMutexLock MutexLock(&_mutex);
+    Macro->id = _nextId++;
+    if (_nextId == 0)
+       _nextId = 1;
+    guint32 id = Macro->id;
+    _queue.Add(Macro);
+    if (!Active())
+       Start();
+    _wakeup.Broadcast();
+    return id;
+  };
+
+  bool CancelMacro(guint32 Id)
+  {
+    _mutex.Lock();
+    if ((Id != 0) && (Id == _playing)) {
+       _cancel = true;
+       _wakeup.Broadcast();
+       _mutex.Unlock();
+       return true;
+       }
+    cDBusRemoteMacro *macro = _queue.First();
+    while ((macro != NULL) && (macro->id != Id))
+          macro = _queue.Next(macro);
+    if (macro != NULL)
+       _queue.Del(macro, false);
+    _mutex.Unlock();
+    if (macro == NULL)
+       return false;
+    cDBusRemote::EmitSignal("MacroFinished", g_variant_new("(uis)", macro->id, 550, "macro cancelled before it was played"));
+    delete macro;
+    return true;
+  };
+};
+
+static cMutex                  MacroPlayerMutex;
+static cDBusRemoteMacroPlayer *MacroPlayer = NULL;
+
+
 class cDbusSelectMenu : public cOsdMenu
 {
 private:
@@ -94,6 +239,22 @@ namespace cDBusRemoteHelper
     "      <arg name=\"replycode\"    type=\"i\"  direction=\"out\"/>\n"
     "      <arg name=\"replymessage\" type=\"s\"  direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"PlayMacro\">\n"
+    "      <arg name=\"keys\"         type=\"a(su)\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"    type=\"i\"     direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\" type=\"s\"     direction=\"out\"/>\n"
+    "      <arg name=\"macroid\"      type=\"u\"     direction=\"out\"/>\n"
+    "    </method>\n"
+    "    <method name=\"CancelMacro\">\n"
+    "      <arg name=\"macroid\"      type=\"u\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+    "    </method>\n"
+    "    <signal name=\"MacroFinished\">\n"
+    "      <arg name=\"macroid\"      type=\"u\"/>\n"
+    "      <arg name=\"replycode\"    type=\"i\"/>\n"
+    "      <arg name=\"replymessage\" type=\"s\"/>\n"
+    "    </signal>\n"
     "    <signal name=\"AskUserSelect\">\n"
     "      <arg name=\"title\"        type=\"s\"/>\n"
     "      <arg name=\"index\"        type=\"i\"/>\n"
@@ -226,6 +387,74 @@ namespace cDBusRemoteHelper
     cDBusHelper::SendReply(Invocation, replyCode, *replyMessage);
   };
 
+  static void SendMacroReply(GDBusMethodInvocation *Invocation, int ReplyCode, const char *ReplyMessage, guint32 Id)
+  {
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new("(isu)", ReplyCode, ReplyMessage, Id));
+  };
+
+  static void PlayMacro(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariant *array = g_variant_get_child_value(Parameters, 0);
+    cDBusRemoteMacro *macro = new cDBusRemoteMacro;
+    cString replyMessage;
+    int replyCode = 250;
+
+    GVariantIter iter;
+    const gchar *keyName = NULL;
+    guint32 delay = 0;
+    g_variant_iter_init(&iter, array);
+    while (g_variant_iter_next(&iter, "(&su)", &keyName, &delay)) {
+          eKeys k = cKey::FromString(keyName);
+          if (k == kNone) {
+             replyCode = 504;
+             replyMessage = cString::sprintf("Unknown key: \"%s\"", keyName);
+             break;
+             }
+          if (delay > MACRO_MAXDELAY) {
+             replyCode = 501;
+             replyMessage = cString::sprintf("delay after key \"%s\" is longer than %d ms", keyName, MACRO_MAXDELAY);
+             break;
+             }
+          macro->keys.Append(k);
+          macro->delays.Append((int)delay);
+          }
+    g_variant_unref(array);
+    if ((replyCode == 250) && (macro->keys.Size() == 0)) {
+       replyCode = 501;
+       replyMessage = "no keys given";
+       }
+    if (replyCode != 250) {
+       esyslog("dbus2vdr: %s.PlayMacro: %s", DBUS_VDR_REMOTE_INTERFACE, *replyMessage);
+       delete macro;
+       SendMacroReply(Invocation, replyCode, *replyMessage, 0);
+       return;
+       }
+
+    int keys = macro->keys.Size();
+    MacroPlayerMutex.Lock();
+    if (MacroPlayer == NULL)
+       MacroPlayer = new cDBusRemoteMacroPlayer;
+    guint32 id = MacroPlayer->Play(macro);
+    MacroPlayerMutex.Unlock();
+    isyslog("dbus2vdr: %s.PlayMacro: macro %u with %d keys queued", DBUS_VDR_REMOTE_INTERFACE, id, keys);
+    SendMacroReply(Invocation, 250, *cString::sprintf("macro with %d key%s queued", keys, (keys > 1) ? "s" : ""), id);
+  };
+
+  static void CancelMacro(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    guint32 id = 0;
+    g_variant_get(Parameters, "(u)", &id);
+
+    MacroPlayerMutex.Lock();
+    bool cancelled = (MacroPlayer != NULL) && MacroPlayer->CancelMacro(id);
+    MacroPlayerMutex.Unlock();
+    if (!cancelled) {
+       cDBusHelper::SendReply(Invocation, 550, *cString::sprintf("macro %u is neither playing nor queued", id));
+       return;
+       }
+    cDBusHelper::SendReply(Invocation, 250, *cString::sprintf("macro %u cancelled", id));
+  };
+
   static void AskUser(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
     if (cDBusRemote::MainMenuAction != NULL) {
@@ -433,15 +662,32 @@ cDBusRemote::cDBusRemote(void)
   AddMethod("CallPlugin", cDBusRemoteHelper::CallPlugin);
   AddMethod("Enable", cDBusRemoteHelper::Enable);
   AddMethod("Disable", cDBusRemoteHelper::Disable);
-  AddMethod("Status", cDBusRemoteHelper::Status);
-  AddMethod("HitKey", cDBusRemoteHelper::HitKey);
-  AddMethod("HitKeys", cDBusRemoteHelper::HitKeys);
+  AddMethod("Status", cDBusRemoteHelper::Status, true);
+  AddMethod("HitKey", cDBusRemoteHelper::HitKey, true);
+  AddMethod("HitKeys", cDBusRemoteHelper::HitKeys, true);
   AddMethod("AskUser", cDBusRemoteHelper::AskUser);
   AddMethod("SwitchChannel", cDBusRemoteHelper::SwitchChannel);
-  AddMethod("GetVolume", cDBusRemoteHelper::GetVolume);
+  AddMethod("GetVolume", cDBusRemoteHelper::GetVolume, true);
   AddMethod("SetVolume", cDBusRemoteHelper::SetVolume);
+  AddMethod("PlayMacro", cDBusRemoteHelper::PlayMacro);
+  AddMethod("CancelMacro", cDBusRemoteHelper::CancelMacro);
 }
 
 cDBusRemote::~cDBusRemote(void)
 {
 }
+
+void cDBusRemote::EmitSignal(const char *Signal, GVariant *Parameters)
+{
+  cDBusObject::EmitSignal("/Remote", DBUS_VDR_REMOTE_INTERFACE, Signal, Parameters);
+}
+
+void cDBusRemote::StopMacros(void)
+{
+  MacroPlayerMutex.Lock();
+  cDBusRemoteMacroPlayer *player = MacroPlayer;
+  MacroPlayer = NULL;
+  MacroPlayerMutex.Unlock();
+  // waits for the player thread
+  delete player;
+}
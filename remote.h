@@ -13,6 +13,11 @@ public:
 
   cDBusRemote(void);
   virtual ~cDBusRemote(void);
+
+  // emits the signal on all remote objects
+  static void EmitSignal(const char *Signal, GVariant *Parameters);
+  // cancels the playing macro and drops the queued ones
+  static void StopMacros(void);
 };
 
 #endif
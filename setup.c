@@ -1,7 +1,9 @@
 #include "setup.h"
 #include "common.h"
+#include "connection.h"
 #include "helper.h"
 
+#include <ctype.h>
 #include <limits.h>
 
 #include <vdr/config.h>
@@ -11,6 +13,23 @@
 #include <vdr/recording.h>
 #include <vdr/themes.h>
 
+#define SETUP_CHECK_INTERVAL 500 // ms between two checks for changes
+
+
+// setup keys are case insensitive
+static guint SetupKeyHash(gconstpointer Key)
+{
+  // djb2 like g_str_hash
+  guint hash = 5381;
+  for (const char *p = (const char*)Key; *p; p++)
+      hash = (hash << 5) + hash + tolower(*p);
+  return hash;
+}
+
+static gboolean SetupKeyEqual(gconstpointer A, gconstpointer B)
+{
+  return strcasecmp((const char*)A, (const char*)B) == 0;
+}
 
 class cDBusSetupHelper
 {
@@ -18,6 +37,53 @@ public:
   static const char *_xmlNodeInfo;
 
 private:
+  // "plugin.name" for plugin settings
+  static cString SetupKey(const char *Plugin, const char *Name)
+  {
+    if (Plugin == NULL)
+       return Name;
+    return cString::sprintf("%s.%s", Plugin, Name);
+  };
+
+  // the lines of a setup by their keys, vdr and the plugins change the setup
+  // without notice, so an index is only valid while handling one call
+  class cSetupLineIndex
+  {
+  private:
+    GHashTable *_lines;
+
+  public:
+    cSetupLineIndex(cConfig<cSetupLine>& config)
+    {
+      _lines = g_hash_table_new_full(SetupKeyHash, SetupKeyEqual, g_free, NULL);
+      for (cSetupLine *sl = config.First(); sl; sl = config.Next(sl)) {
+          // the first line wins like with a linear search
+          cString key = SetupKey(sl->Plugin(), sl->Name());
+          if (!g_hash_table_contains(_lines, *key))
+             g_hash_table_insert(_lines, g_strdup(*key), sl);
+          }
+    };
+
+    ~cSetupLineIndex(void)
+    {
+      g_hash_table_destroy(_lines);
+    };
+
+    cSetupLine *Find(const char *key) const
+    {
+      if (key == NULL)
+         return NULL;
+      return (cSetupLine*)g_hash_table_lookup(_lines, key);
+    };
+
+    // a new line replaces the indexed one with the same key
+    void Replace(cSetupLine *line)
+    {
+      cString key = SetupKey(line->Plugin(), line->Name());
+      g_hash_table_insert(_lines, g_strdup(*key), line);
+    };
+  };
+
   static cSetupLine *FindSetupLine(cConfig<cSetupLine>& config, const char *name, const char *plugin)
   {
     if (name != NULL) {
@@ -33,6 +99,31 @@ private:
     return NULL;
   };
 
+  // like the above with "plugin.name" but without copying the name,
+  // surrounding whitespace is ignored
+  static cSetupLine *FindSetupLine(cConfig<cSetupLine>& config, const char *name)
+  {
+    if (name == NULL)
+       return NULL;
+    name = skipspace(name);
+    int len = strlen(name);
+    while ((len > 0) && isspace(name[len - 1]))
+          len--;
+    const char *point = (const char*)memchr(name, '.', len);
+    const char *key = (point == NULL) ? name : point + 1;
+    int pluginLen = (point == NULL) ? 0 : point - name;
+    int keyLen = len - (key - name);
+    for (cSetupLine *sl = config.First(); sl; sl = config.Next(sl)) {
+        if ((sl->Plugin() == NULL) != (point == NULL))
+           continue;
+        if ((point != NULL) && (((int)strlen(sl->Plugin()) != pluginLen) || (strncasecmp(sl->Plugin(), name, pluginLen) != 0)))
+           continue;
+        if (((int)strlen(sl->Name()) == keyLen) && (strncasecmp(sl->Name(), key, keyLen) == 0))
+           return sl;
+        }
+    return NULL;
+  };
+
   class cSetupBinding : public cListObject
   {
   private:
@@ -85,20 +176,262 @@ private:
       b->Value = value;
       return b;
     }
-
-    static const cSetupBinding* Find(const cList<cSetupBinding>& bindings, const char *name)
-    {
-      if (name == NULL)
-         return NULL;
-      const cSetupBinding *sb = bindings.First();
-      while ((sb != NULL) && (strcasecmp(sb->Name, name) != 0))
-            sb = bindings.Next(sb);
-      return sb;
-    }
   };
   static cList<cSetupBinding> _bindings;
+  static GHashTable          *_bindingIndex; // name -> cSetupBinding
+
+  static const cSetupBinding *FindBinding(const char *name)
+  {
+    if ((name == NULL) || (_bindingIndex == NULL))
+       return NULL;
+    return (const cSetupBinding*)g_hash_table_lookup(_bindingIndex, name);
+  };
+
+  static GVariant *BindingValue(const cSetupBinding *b)
+  {
+    switch (b->Type) {
+      case cSetupBinding::dstString:
+        return g_variant_new_string((const char*)b->Value);
+      case cSetupBinding::dstInt32:
+        return g_variant_new_int32(*(int*)(b->Value));
+      case cSetupBinding::dstTimeT:
+        return g_variant_new_int64(*(time_t*)(b->Value));
+      }
+    return NULL;
+  };
+
+  // checks the type and the range of a new value
+  static bool CheckBinding(const cSetupBinding *b, const char *name, GVariant *value, cString &replyMessage)
+  {
+    switch (b->Type) {
+      case cSetupBinding::dstString:
+       {
+        if (!g_variant_is_of_type(value, G_VARIANT_TYPE_STRING)) {
+           replyMessage = cString::sprintf("argument for %s is not a string", name);
+           return false;
+           }
+        break;
+       }
+      case cSetupBinding::dstInt32:
+       {
+        if (!g_variant_is_of_type(value, G_VARIANT_TYPE_INT32)) {
+           replyMessage = cString::sprintf("argument for %s is not a 32bit-integer", name);
+           return false;
+           }
+        gint32 i32 = g_variant_get_int32(value);
+        if ((i32 < b->Int32MinValue) || (i32 > b->Int32MaxValue)) {
+           replyMessage = cString::sprintf("argument for %s is out of range", name);
+           return false;
+           }
+        break;
+       }
+      case cSetupBinding::dstTimeT:
+       {
+        if (!g_variant_is_of_type(value, G_VARIANT_TYPE_INT64)) {
+           replyMessage = cString::sprintf("argument for %s is not a 64bit-integer", name);
+           return false;
+           }
+        break;
+       }
+      }
+    return true;
+  };
+
+  // the value must have passed CheckBinding
+  static void ApplyBinding(const cSetupBinding *b, const char *name, GVariant *value, cString &replyMessage, bool &ModifiedAppearance)
+  {
+    switch (b->Type) {
+      case cSetupBinding::dstString:
+       {
+        const char *str = g_variant_get_string(value, NULL);
+        replyMessage = cString::sprintf("setting %s = %s", name, str);
+        Utf8Strn0Cpy((char*)b->Value, str, b->StrMaxLength);
+        // special handling of some setup values
+        if ((strcasecmp(name, "OSDLanguage") == 0)
+         || (strcasecmp(name, "FontOsd") == 0)
+         || (strcasecmp(name, "FontSml") == 0)
+         || (strcasecmp(name, "FontFix") == 0)) {
+           ModifiedAppearance = true;
+           }
+        else if (strcasecmp(name, "OSDSkin") == 0) {
+           Skins.SetCurrent(str);
+           ModifiedAppearance = true;
+           }
+        else if (strcasecmp(name, "OSDTheme") == 0) {
+           cThemes themes;
+           themes.Load(Skins.Current()->Name());
+           if ((themes.NumThemes() > 0) && Skins.Current()->Theme()) {
+              int themeIndex = themes.GetThemeIndex(str);
+              if (themeIndex >= 0) {
+                 Skins.Current()->Theme()->Load(themes.FileName(themeIndex));
+                 ModifiedAppearance = true;
+                 }
+              }
+           }
+        break;
+       }
+      case cSetupBinding::dstInt32:
+       {
+        gint32 i32 = g_variant_get_int32(value);
+        replyMessage = cString::sprintf("setting %s = %d", name, i32);
+        (*((int*)b->Value)) = i32;
+        if (strcasecmp(name, "AntiAlias") == 0)
+           ModifiedAppearance = true;
+        break;
+       }
+      case cSetupBinding::dstTimeT:
+       {
+        time_t i64 = g_variant_get_int64(value);
+        replyMessage = cString::sprintf("setting %s = %ld", name, i64);
+        (*((time_t*)b->Value)) = i64;
+        break;
+       }
+      }
+  };
+
+  // one entry of SetMany
+  class cSetupChange : public cListObject
+  {
+  public:
+    const char          *name;
+    GVariant            *value;
+    const cSetupBinding *binding;
+    cPlugin             *plugin;
+    cString              pluginName;
+    cString              key;
+    bool                 hadOldValue;
+    cString              oldValue;
+
+    cSetupChange(const char *Name, GVariant *Value)
+     :name(Name),value(Value),binding(NULL),plugin(NULL),hadOldValue(false) {};
+    virtual ~cSetupChange(void) { g_variant_unref(value); };
+  };
+
+private:
+  static void AddHash(guint64 &hash, const void *data, size_t size)
+  {
+    // FNV-1a
+    const uchar *p = (const uchar*)data;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ p[i]) * 1099511628211ULL;
+  };
+
+  static void AddHash(guint64 &hash, const char *str)
+  {
+    if (str != NULL)
+       AddHash(hash, str, strlen(str) + 1);
+    else
+       AddHash(hash, "", 1);
+  };
+
+  // cheaper than a snapshot and good enough to notice a change,
+  // bindings hide the setup lines with the same name like in List
+  static guint64 SetupHash(void)
+  {
+    guint64 hash = 14695981039346656037ULL;
+    for (cSetupBinding *b = _bindings.First(); b; b = _bindings.Next(b)) {
+        switch (b->Type) {
+          case cSetupBinding::dstString:
+            AddHash(hash, (const char*)b->Value);
+            break;
+          case cSetupBinding::dstInt32:
+            AddHash(hash, b->Value, sizeof(int));
+            break;
+          case cSetupBinding::dstTimeT:
+            AddHash(hash, b->Value, sizeof(time_t));
+            break;
+          }
+        }
+    for (cSetupLine *line = Setup.First(); line; line = Setup.Next(line)) {
+        if ((line->Plugin() == NULL) && (FindBinding(line->Name()) != NULL))
+           continue;
+        AddHash(hash, line->Plugin());
+        AddHash(hash, line->Name());
+        AddHash(hash, line->Value());
+        }
+    return hash;
+  };
+
+  // key -> GVariant with the value as returned by Get
+  static GHashTable *Snapshot(void)
+  {
+    GHashTable *snapshot = g_hash_table_new_full(SetupKeyHash, SetupKeyEqual, g_free, (GDestroyNotify)g_variant_unref);
+    for (cSetupBinding *b = _bindings.First(); b; b = _bindings.Next(b))
+        g_hash_table_insert(snapshot, g_strdup(b->Name), g_variant_ref_sink(BindingValue(b)));
+    for (cSetupLine *line = Setup.First(); line; line = Setup.Next(line)) {
+        cString key = SetupKey(line->Plugin(), line->Name());
+        if (!g_hash_table_contains(snapshot, *key))
+           g_hash_table_insert(snapshot, g_strdup(*key), g_variant_ref_sink(g_variant_new_string(line->Value())));
+        }
+    return snapshot;
+  };
+
+  // the methods run in the thread-pool and CheckChanges in vdr's main thread,
+  // the setup lines are only read or changed with this mutex locked
+  static cMutex      _setupMutex;
+  static GHashTable *_snapshot;     // of the last signal
+  static guint64     _snapshotHash;
+  static guint64     _lastHash;     // of the last check
+  static cTimeMs     _nextCheck;
 
 public:
+  static void CheckChanges(void)
+  {
+    if (!_nextCheck.TimedOut())
+       return;
+    _nextCheck.Set(SETUP_CHECK_INTERVAL);
+    cMutexLock SetupLock(&_setupMutex);
+
+    guint64 hash = SetupHash();
+    // changed by the menu or a plugin
+    if (hash != _lastHash)
+       InvalidateList();
+    if (_snapshot == NULL) {
+       _snapshot = Snapshot();
+       _snapshotHash = _lastHash = hash;
+       return;
+       }
+    // wait until a burst of changes like loading the setup.conf is over
+    bool stable = (hash == _lastHash);
+    _lastHash = hash;
+    if (!stable || (hash == _snapshotHash))
+       return;
+
+    GHashTable *snapshot = Snapshot();
+    GVariantBuilder *changed = g_variant_builder_new(G_VARIANT_TYPE("a(sv)"));
+    GVariantBuilder *deleted = g_variant_builder_new(G_VARIANT_TYPE("as"));
+    int count = 0;
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    g_hash_table_iter_init(&iter, snapshot);
+    while (g_hash_table_iter_next(&iter, &key, &value)) {
+          GVariant *old = (GVariant*)g_hash_table_lookup(_snapshot, key);
+          if ((old == NULL) || !g_variant_equal(old, value)) {
+             g_variant_builder_add(changed, "(sv)", (const char*)key, (GVariant*)value);
+             count++;
+             }
+          }
+    g_hash_table_iter_init(&iter, _snapshot);
+    while (g_hash_table_iter_next(&iter, &key, NULL)) {
+          if (!g_hash_table_contains(snapshot, key)) {
+             g_variant_builder_add(deleted, "s", (const char*)key);
+             count++;
+             }
+          }
+    g_hash_table_destroy(_snapshot);
+    _snapshot = snapshot;
+    _snapshotHash = hash;
+
+    // the order of the lines may have changed only
+    if (count > 0) {
+       d4syslog("dbus2vdr: %s: %d settings changed", DBUS_VDR_SETUP_INTERFACE, count);
+       cDBusSetup::EmitSignal("SetupChanged", g_variant_new("(a(sv)as)", changed, deleted));
+       }
+    g_variant_builder_unref(changed);
+    g_variant_builder_unref(deleted);
+  };
+
   static void InitBindings(void)
   {
     if (_bindings.Count() == 0) {
@@ -188,12 +521,31 @@ public:
        _bindings.Add(cSetupBinding::NewInt32(&Setup.EmergencyExit, "EmergencyExit", 0, 1));
 
        _bindings.Sort();
+       _bindingIndex = g_hash_table_new(SetupKeyHash, SetupKeyEqual);
+       for (cSetupBinding *b = _bindings.First(); b; b = _bindings.Next(b))
+           g_hash_table_insert(_bindingIndex, (gpointer)b->Name, b);
        }
   }
 
-public:
-  static void List(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+private:
+  // the reply of List is kept until the setup changes
+  static cMutex    _listMutex;
+  static GVariant *_listReply;
+  static int       _listGeneration;
+
+  static void InvalidateList(void)
+  {
+    cMutexLock MutexLock(&_listMutex);
+    _listGeneration++;
+    if (_listReply != NULL) {
+       g_variant_unref(_listReply);
+       _listReply = NULL;
+       }
+  };
+
+  static GVariant *BuildList(void)
   {
+    cMutexLock SetupLock(&_setupMutex);
     // a(sv)
     GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(sv)"));
     GVariantBuilder *element = NULL;
@@ -248,7 +600,7 @@ public:
     cString name;
     for (cSetupLine *line = Setup.First(); line; line = Setup.Next(line)) {
         // output all plugins and unknown settings
-        if ((line->Plugin() == NULL) && (cSetupBinding::Find(_bindings, line->Name()) != NULL))
+        if ((line->Plugin() == NULL) && (FindBinding(line->Name()) != NULL))
            continue;
         element = g_variant_builder_new(G_VARIANT_TYPE("(sv)"));
         if (line->Plugin() == NULL)
@@ -270,50 +622,46 @@ public:
 
     GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(a(sv))"));
     g_variant_builder_add_value(builder, g_variant_builder_end(array));
-    g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
+    GVariant *reply = g_variant_builder_end(builder);
     g_variant_builder_unref(array);
     g_variant_builder_unref(builder);
+    return reply;
+  };
+
+public:
+  static void List(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    _listMutex.Lock();
+    GVariant *reply = (_listReply != NULL) ? g_variant_ref(_listReply) : NULL;
+    int generation = _listGeneration;
+    _listMutex.Unlock();
+    if (reply == NULL) {
+       // not locked while building, the setup may change meanwhile
+       reply = g_variant_ref_sink(BuildList());
+       _listMutex.Lock();
+       if ((_listReply == NULL) && (generation == _listGeneration))
+          _listReply = g_variant_ref(reply);
+       _listMutex.Unlock();
+       }
+    g_dbus_method_invocation_return_value(Invocation, reply);
+    g_variant_unref(reply);
   };
 
   static void Get(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
+    cMutexLock SetupLock(&_setupMutex);
     const gchar *name = NULL;
     g_variant_get(Parameters, "(&s)", &name);
 
     gint32 replyCode = 501;
     cString replyMessage = "missing arguments";
     if (name != NULL) {
-       const cSetupBinding *b = cSetupBinding::Find(_bindings, name);
+       const cSetupBinding *b = FindBinding(name);
        if (b == NULL) {
-          char *point = (char*)strchr(name, '.');
-          char *plugin = NULL;
-          const char *key = NULL;
-          char *dummy = NULL;
-          if (point == NULL) { // this is an unknown setting
-             key = name;
-             isyslog("dbus2vdr: %s.Get: looking for %s", DBUS_VDR_SETUP_INTERFACE, key);
-             }
-          else { // this is a plugin setting
-             dummy = strdup(name);
-             plugin = compactspace(dummy);
-             point = strchr(plugin, '.');
-             *point = 0;
-             key = point + 1;
-             isyslog("dbus2vdr: %s.Get: looking for %s.%s", DBUS_VDR_SETUP_INTERFACE, plugin, key);
-             }
-          const char *value = NULL;
-          for (cSetupLine *line = Setup.First(); line; line = Setup.Next(line)) {
-              if ((line->Plugin() == NULL) != (plugin == NULL))
-                 continue;
-              if ((plugin != NULL) && (strcasecmp(plugin, line->Plugin()) != 0))
-                 continue;
-              if (strcasecmp(key, line->Name()) != 0)
-                 continue;
-              value = line->Value();
-              break;
-              }
-          if (dummy != NULL)
-             free(dummy);
+          // this is a plugin or an unknown setting
+          isyslog("dbus2vdr: %s.Get: looking for %s", DBUS_VDR_SETUP_INTERFACE, name);
+          const cSetupLine *line = FindSetupLine(Setup, name);
+          const char *value = (line != NULL) ? line->Value() : NULL;
           if (value == NULL) {
              replyMessage = cString::sprintf("%s not found in setup.conf", name);
              esyslog("dbus2vdr: %s.Get: %s not found in setup.conf", DBUS_VDR_SETUP_INTERFACE, name);
@@ -388,6 +736,7 @@ public:
 
   static void Set(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
+    cMutexLock SetupLock(&_setupMutex);
     const gchar *name = NULL;
     GVariant *nameChild = g_variant_get_child_value(Parameters, 0);
     g_variant_get(nameChild, "&s", &name);
@@ -398,7 +747,7 @@ public:
     gint32 replyCode = 501;
     cString replyMessage = "missing arguments";
     if (name != NULL) {
-       const cSetupBinding *b = cSetupBinding::Find(_bindings, name);
+       const cSetupBinding *b = FindBinding(name);
        if (b == NULL) {
           const char *value = NULL;
           if (!g_variant_is_of_type(child, G_VARIANT_TYPE_STRING))
@@ -468,6 +817,7 @@ public:
              if (dummy != NULL)
                 free(dummy);
              }
+          InvalidateList();
           cDBusHelper::SendReply(Invocation, replyCode, *replyMessage);
           g_variant_unref(nameChild);
           g_variant_unref(child);
@@ -477,76 +827,10 @@ public:
 
        bool save = false;
        bool ModifiedAppearance = false;
-       switch (b->Type) {
-         case cSetupBinding::dstString:
-          {
-           const char *str = NULL;
-           if (!g_variant_is_of_type(child, G_VARIANT_TYPE_STRING))
-              replyMessage = cString::sprintf("argument for %s is not a string", name);
-           else {
-              g_variant_get(child, "&s", &str);
-              replyMessage = cString::sprintf("setting %s = %s", name, str);
-              Utf8Strn0Cpy((char*)b->Value, str, b->StrMaxLength);
-              save = true;
-              // special handling of some setup values
-              if ((strcasecmp(name, "OSDLanguage") == 0)
-               || (strcasecmp(name, "FontOsd") == 0)
-               || (strcasecmp(name, "FontSml") == 0)
-               || (strcasecmp(name, "FontFix") == 0)) {
-                 ModifiedAppearance = true;
-                 }
-              else if (strcasecmp(name, "OSDSkin") == 0) {
-                 Skins.SetCurrent(str);
-                 ModifiedAppearance = true;
-                 }
-              else if (strcasecmp(name, "OSDTheme") == 0) {
-                 cThemes themes;
-                 themes.Load(Skins.Current()->Name());
-                 if ((themes.NumThemes() > 0) && Skins.Current()->Theme()) {
-                    int themeIndex = themes.GetThemeIndex(str);
-                    if (themeIndex >= 0) {
-                       Skins.Current()->Theme()->Load(themes.FileName(themeIndex));
-                       ModifiedAppearance = true;
-                       }
-                    }
-                 }
-             }
-           break;
-          }
-         case cSetupBinding::dstInt32:
-          {
-           int i32;
-           if (!g_variant_is_of_type(child, G_VARIANT_TYPE_INT32))
-              replyMessage = cString::sprintf("argument for %s is not a 32bit-integer", name);
-           else {
-              g_variant_get(child, "i", &i32);
-              if ((i32 < b->Int32MinValue) || (i32 > b->Int32MaxValue))
-                 replyMessage = cString::sprintf("argument for %s is out of range", name);
-              else {
-                 replyMessage = cString::sprintf("setting %s = %d", name, i32);
-                 (*((int*)b->Value)) = i32;
-                 save = true;
-                 if (strcasecmp(name, "AntiAlias") == 0) {
-                    ModifiedAppearance = true;
-                    }
-                 }
-              }
-           break;
-          }
-         case cSetupBinding::dstTimeT:
-          {
-           time_t i64;
-           if (!g_variant_is_of_type(child, G_VARIANT_TYPE_INT64))
-              replyMessage = cString::sprintf("argument for %s is not a 64bit-integer", name);
-           else {
-              g_variant_get(child, "x", &i64);
-              replyMessage = cString::sprintf("setting %s = %ld", name, i64);
-              (*((time_t*)b->Value)) = i64;
-              save = true;
-              }
-           break;
+       if (CheckBinding(b, name, child, replyMessage)) {
+          ApplyBinding(b, name, child, replyMessage, ModifiedAppearance);
+          save = true;
           }
-         }
 
        if (save) {
           Setup.Save();
@@ -555,6 +839,7 @@ public:
           if (ModifiedAppearance)
              cOsdProvider::UpdateOsdSize(true);
 #endif
+          InvalidateList();
           }
        }
 
@@ -564,8 +849,175 @@ public:
     g_variant_unref(variant);
   };
 
+  static void GetMany(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    cMutexLock SetupLock(&_setupMutex);
+    GVariant *names = g_variant_get_child_value(Parameters, 0);
+    GVariantBuilder *values = g_variant_builder_new(G_VARIANT_TYPE("a(sv)"));
+    GVariantBuilder *missing = g_variant_builder_new(G_VARIANT_TYPE("as"));
+    cSetupLineIndex *lines = NULL; // only needed for plugin and unknown settings
+
+    GVariantIter iter;
+    const gchar *name = NULL;
+    g_variant_iter_init(&iter, names);
+    while (g_variant_iter_next(&iter, "&s", &name)) {
+          GVariant *value = NULL;
+          const cSetupBinding *b = FindBinding(name);
+          if (b != NULL)
+             value = BindingValue(b);
+          else {
+             if (lines == NULL)
+                lines = new cSetupLineIndex(Setup);
+             const cSetupLine *line = lines->Find(name);
+             if (line != NULL)
+                value = g_variant_new_string(line->Value());
+             }
+          if (value != NULL)
+             g_variant_builder_add(values, "(sv)", name, value);
+          else
+             g_variant_builder_add(missing, "s", name);
+          }
+    delete lines;
+
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new("(a(sv)as)", values, missing));
+    g_variant_builder_unref(values);
+    g_variant_builder_unref(missing);
+    g_variant_unref(names);
+  };
+
+  static void SetMany(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    cMutexLock SetupLock(&_setupMutex);
+    GVariant *array = g_variant_get_child_value(Parameters, 0);
+    cList<cSetupChange> changes; // the names point into the array
+    cString replyMessage;
+    bool valid = true;
+
+    // nothing is changed before all values are checked
+    cSetupLineIndex *lines = new cSetupLineIndex(Setup);
+    GVariantIter iter;
+    const gchar *name = NULL;
+    GVariant *value = NULL;
+    g_variant_iter_init(&iter, array);
+    while (valid && g_variant_iter_next(&iter, "(&sv)", &name, &value)) {
+          cSetupChange *c = new cSetupChange(name, value);
+          changes.Add(c);
+          c->binding = FindBinding(name);
+          if (c->binding != NULL) {
+             valid = CheckBinding(c->binding, name, value, replyMessage);
+             continue;
+             }
+          if (!g_variant_is_of_type(value, G_VARIANT_TYPE_STRING)) {
+             replyMessage = cString::sprintf("argument for %s is not a string", name);
+             valid = false;
+             continue;
+             }
+          char *dummy = strdup(name);
+          char *setting = compactspace(dummy);
+          char *point = strchr(setting, '.');
+          if (point == NULL)
+             c->key = setting;
+          else { // this is a plugin setting
+             *point = 0;
+             c->pluginName = setting;
+             c->key = point + 1;
+             c->plugin = cPluginManager::GetPlugin(*c->pluginName);
+             }
+          free(dummy);
+          const cSetupLine *line = lines->Find(*SetupKey(*c->pluginName, *c->key));
+          if (line != NULL) {
+             c->hadOldValue = true;
+             c->oldValue = line->Value();
+             }
+          }
+    delete lines;
+    if (!valid) {
+       esyslog("dbus2vdr: %s.SetMany: %s", DBUS_VDR_SETUP_INTERFACE, *replyMessage);
+       cDBusHelper::SendReply(Invocation, 501, *replyMessage);
+       changes.Clear();
+       g_variant_unref(array);
+       return;
+       }
+
+    // the plugins may refuse a value, so they are asked first
+    for (cSetupChange *c = changes.First(); c; c = changes.Next(c)) {
+        if (c->plugin == NULL)
+           continue;
+        const char *str = g_variant_get_string(c->value, NULL);
+        if (c->plugin->SetupParse(*c->key, str)) {
+           c->plugin->SetupStore(*c->key, str);
+           continue;
+           }
+        replyMessage = cString::sprintf("plugin %s can't parse %s = %s", *c->pluginName, *c->key, str);
+        esyslog("dbus2vdr: %s.SetMany: %s", DBUS_VDR_SETUP_INTERFACE, *replyMessage);
+        // restore the values of the plugins asked before
+        for (cSetupChange *r = changes.Prev(c); r; r = changes.Prev(r)) {
+            if (r->plugin == NULL)
+               continue;
+            if (r->hadOldValue)
+               r->plugin->SetupParse(*r->key, *r->oldValue);
+            else
+               isyslog("dbus2vdr: %s.SetMany: can't restore %s.%s, it wasn't set before", DBUS_VDR_SETUP_INTERFACE, *r->pluginName, *r->key);
+            r->plugin->SetupStore(*r->key, r->hadOldValue ? *r->oldValue : NULL);
+            }
+        InvalidateList();
+        cDBusHelper::SendReply(Invocation, 501, *replyMessage);
+        changes.Clear();
+        g_variant_unref(array);
+        return;
+        }
+
+    bool ModifiedAppearance = false;
+    int direct = 0;
+    for (cSetupChange *c = changes.First(); c; c = changes.Next(c)) {
+        if (c->binding != NULL)
+           ApplyBinding(c->binding, c->name, c->value, replyMessage, ModifiedAppearance);
+        else if (c->plugin == NULL)
+           direct++;
+        }
+
+    if (direct == 0)
+       Setup.Save();
+    else {
+       // like Set: the lines of unloaded plugins and unknown settings are changed
+       // in the file, vdr parses them while reloading it
+       Setup.Save();
+       char *filename = strdup(Setup.FileName());
+       cConfig<cSetupLine> tmpSetup;
+       tmpSetup.Load(filename, true);
+       cSetupLineIndex tmpLines(tmpSetup);
+       for (cSetupChange *c = changes.First(); c; c = changes.Next(c)) {
+           if ((c->binding != NULL) || (c->plugin != NULL))
+              continue;
+           cSetupLine *newLine = new cSetupLine(*c->key, g_variant_get_string(c->value, NULL), *c->pluginName);
+           cSetupLine *line = tmpLines.Find(*SetupKey(*c->pluginName, *c->key));
+           if (line != NULL) {
+              tmpSetup.Add(newLine, line);
+              tmpSetup.Del(line);
+              }
+           else
+              tmpSetup.Add(newLine);
+           tmpLines.Replace(newLine);
+           }
+       tmpSetup.Save();
+       Setup.Load(filename);
+       free(filename);
+       }
+#if VDRVERSNUM > 10706
+    if (ModifiedAppearance)
+       cOsdProvider::UpdateOsdSize(true);
+#endif
+
+    InvalidateList();
+    isyslog("dbus2vdr: %s.SetMany: stored %d settings", DBUS_VDR_SETUP_INTERFACE, changes.Count());
+    cDBusHelper::SendReply(Invocation, 900, *cString::sprintf("stored %d settings", changes.Count()));
+    changes.Clear();
+    g_variant_unref(array);
+  };
+
   static void Del(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
+    cMutexLock SetupLock(&_setupMutex);
     const gchar *name = NULL;
     g_variant_get(Parameters, "(&s)", &name);
 
@@ -586,6 +1038,7 @@ public:
              line = next;
              }
        Setup.Save();
+       InvalidateList();
        cDBusHelper::SendReply(Invocation, 900, *cString::sprintf("deleted all settings for plugin %s", plugin));
        free(plugin);
        return;
@@ -602,6 +1055,7 @@ public:
         if (line->Compare(delLine) == 0) {
            Setup.Del(line);
            Setup.Save();
+           InvalidateList();
            cDBusHelper::SendReply(Invocation, 900, *cString::sprintf("%s deleted from setup.conf", name));
            return;
            }
@@ -612,6 +1066,15 @@ public:
 };
 
 cList<cDBusSetupHelper::cSetupBinding> cDBusSetupHelper::_bindings;
+GHashTable *cDBusSetupHelper::_bindingIndex = NULL;
+cMutex      cDBusSetupHelper::_setupMutex;
+GHashTable *cDBusSetupHelper::_snapshot = NULL;
+guint64     cDBusSetupHelper::_snapshotHash = 0;
+guint64     cDBusSetupHelper::_lastHash = 0;
+cTimeMs     cDBusSetupHelper::_nextCheck;
+cMutex      cDBusSetupHelper::_listMutex;
+GVariant   *cDBusSetupHelper::_listReply = NULL;
+int         cDBusSetupHelper::_listGeneration = 0;
 
 const char *cDBusSetupHelper::_xmlNodeInfo = 
     "<!DOCTYPE node PUBLIC \"-//freedesktop//DTD D-BUS Object Introspection 1.0//EN\"\n"
@@ -633,11 +1096,25 @@ const char *cDBusSetupHelper::_xmlNodeInfo =
     "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
     "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"GetMany\">\n"
+    "      <arg name=\"names\"        type=\"as\"    direction=\"in\"/>\n"
+    "      <arg name=\"values\"       type=\"a(sv)\" direction=\"out\"/>\n"
+    "      <arg name=\"missing\"      type=\"as\"    direction=\"out\"/>\n"
+    "    </method>\n"
+    "    <method name=\"SetMany\">\n"
+    "      <arg name=\"values\"       type=\"a(sv)\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+    "    </method>\n"
     "    <method name=\"Del\">\n"
     "      <arg name=\"name\"         type=\"s\" direction=\"in\"/>\n"
     "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
     "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
     "    </method>\n"
+    "    <signal name=\"SetupChanged\">\n"
+    "      <arg name=\"changed\"      type=\"a(sv)\"/>\n"
+    "      <arg name=\"deleted\"      type=\"as\"/>\n"
+    "    </signal>\n"
     "  </interface>\n"
     "</node>\n";
 
@@ -649,9 +1126,21 @@ cDBusSetup::cDBusSetup(void)
   AddMethod("List", cDBusSetupHelper::List);
   AddMethod("Get", cDBusSetupHelper::Get);
   AddMethod("Set", cDBusSetupHelper::Set);
+  AddMethod("GetMany", cDBusSetupHelper::GetMany);
+  AddMethod("SetMany", cDBusSetupHelper::SetMany);
   AddMethod("Del", cDBusSetupHelper::Del);
 }
 
 cDBusSetup::~cDBusSetup(void)
 {
 }
+
+void cDBusSetup::EmitSignal(const char *Signal, GVariant *Parameters)
+{
+  cDBusObject::EmitSignal("/Setup", DBUS_VDR_SETUP_INTERFACE, Signal, Parameters);
+}
+
+void cDBusSetup::CheckChanges(void)
+{
+  cDBusSetupHelper::CheckChanges();
+}
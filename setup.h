@@ -9,6 +9,12 @@ class cDBusSetup : public cDBusObject
 public:
   cDBusSetup(void);
   virtual ~cDBusSetup(void);
+
+  // emits the signal on all setup objects
+  static void EmitSignal(const char *Signal, GVariant *Parameters);
+  // must be called by the main thread, emits "SetupChanged"
+  // when the setup didn't change any more after a change
+  static void CheckChanges(void);
 };
 
 #endif
@@ -20,6 +20,9 @@ namespace cDBusStatusHelper
     "      <arg name=\"Timer\"           type=\"s\" direction=\"out\"/>\n"
     "      <arg name=\"Change\"          type=\"s\" direction=\"out\"/>\n"
     "    </signal>\n"
+    "    <signal name=\"TimerBatchChange\">\n"
+    "      <arg name=\"Changes\"         type=\"a(ss)\" direction=\"out\"/>\n"
+    "    </signal>\n"
     "    <signal name=\"ChannelSwitch\">\n"
     "      <arg name=\"DeviceNumber\"    type=\"i\" direction=\"out\"/>\n"
     "      <arg name=\"ChannelNumber\"   type=\"i\" direction=\"out\"/>\n"
@@ -61,6 +64,9 @@ namespace cDBusStatusHelper
 
 #define EMPTY(s) (s == NULL ? "" : s)
 
+  // set while the thread applies a batch of timer changes
+  static GPrivate _timerBatch = G_PRIVATE_INIT(NULL);
+
   class cVdrStatus : public cStatus
   {
   private:
@@ -128,6 +134,9 @@ namespace cDBusStatusHelper
 
     virtual void TimerChange(const cTimer *Timer, eTimerChange Change)
     {
+      if (g_private_get(&_timerBatch) != NULL)
+         return;
+
       const char *timer = NULL;
       const char *change = NULL;
 
@@ -328,3 +337,17 @@ cDBusStatus::~cDBusStatus(void)
 {
   delete _status;
 }
+
+void cDBusStatus::StartTimerBatch(void)
+{
+  g_private_set(&cDBusStatusHelper::_timerBatch, GINT_TO_POINTER(1));
+}
+
+void cDBusStatus::FinishTimerBatch(GVariant *Changes)
+{
+  g_private_set(&cDBusStatusHelper::_timerBatch, NULL);
+  if (Changes == NULL)
+     return;
+
+  cDBusObject::EmitSignal("/Status", DBUS_VDR_STATUS_INTERFACE, "TimerBatchChange", Changes);
+}
@@ -22,6 +22,11 @@ private:
 public:
   cDBusStatus(bool Network);
   virtual ~cDBusStatus(void);
+
+  // suppresses the "TimerChange" signals caused by the calling thread
+  // until FinishTimerBatch emits all changes as one "TimerBatchChange"
+  static void StartTimerBatch(void);
+  static void FinishTimerBatch(GVariant *Changes);
 };
 
 #endif
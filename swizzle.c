@@ -0,0 +1,126 @@
+#include "swizzle.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SWIZZLE_SSSE3
+#include <tmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SWIZZLE_NEON
+#include <arm_neon.h>
+#endif
+
+static void BgraToRgbaScalar(uint8_t *Dst, const uint8_t *Src, int Pixels)
+{
+  for (int i = 0; i < Pixels; i++) {
+      Dst[0] = Src[2];
+      Dst[1] = Src[1];
+      Dst[2] = Src[0];
+      Dst[3] = Src[3];
+      Dst += 4;
+      Src += 4;
+      }
+}
+
+#ifdef SWIZZLE_SSSE3
+__attribute__((target("ssse3")))
+static void BgraToRgbaSsse3(uint8_t *Dst, const uint8_t *Src, int Pixels)
+{
+  const __m128i mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  int i = 0;
+  for (; i + 4 <= Pixels; i += 4) {
+      __m128i v = _mm_loadu_si128((const __m128i*)(Src + i * 4));
+      _mm_storeu_si128((__m128i*)(Dst + i * 4), _mm_shuffle_epi8(v, mask));
+      }
+  BgraToRgbaScalar(Dst + i * 4, Src + i * 4, Pixels - i);
+}
+#endif
+
+#ifdef SWIZZLE_NEON
+static void BgraToRgbaNeon(uint8_t *Dst, const uint8_t *Src, int Pixels)
+{
+  int i = 0;
+  for (; i + 16 <= Pixels; i += 16) {
+      uint8x16x4_t v = vld4q_u8(Src + i * 4);
+      uint8x16_t b = v.val[0];
+      v.val[0] = v.val[2];
+      v.val[2] = b;
+      vst4q_u8(Dst + i * 4, v);
+      }
+  BgraToRgbaScalar(Dst + i * 4, Src + i * 4, Pixels - i);
+}
+#endif
+
+typedef void (*tBgraToRgba)(uint8_t *Dst, const uint8_t *Src, int Pixels);
+
+bool SwizzleKernelAvailable(eSwizzleKernel Kernel)
+{
+  switch (Kernel) {
+    case swizzleScalar:
+    case swizzleAuto:
+      return true;
+    case swizzleSsse3:
+#ifdef SWIZZLE_SSSE3
+      return __builtin_cpu_supports("ssse3");
+#else
+      return false;
+#endif
+    case swizzleNeon:
+#ifdef SWIZZLE_NEON
+      return true;
+#else
+      return false;
+#endif
+    }
+  return false;
+}
+
+const char *SwizzleKernelName(eSwizzleKernel Kernel)
+{
+  switch (Kernel) {
+    case swizzleScalar: return "scalar";
+    case swizzleSsse3:  return "ssse3";
+    case swizzleNeon:   return "neon";
+    case swizzleAuto:   return "auto";
+    }
+  return "unknown";
+}
+
+static tBgraToRgba SwizzleKernel(eSwizzleKernel Kernel)
+{
+  if (!SwizzleKernelAvailable(Kernel))
+     return BgraToRgbaScalar;
+  switch (Kernel) {
+#ifdef SWIZZLE_SSSE3
+    case swizzleSsse3:
+      return BgraToRgbaSsse3;
+#endif
+#ifdef SWIZZLE_NEON
+    case swizzleNeon:
+      return BgraToRgbaNeon;
+#endif
+    default:
+      break;
+    }
+  return BgraToRgbaScalar;
+}
+
+static tBgraToRgba BestKernel(void)
+{
+  if (SwizzleKernelAvailable(swizzleSsse3))
+     return SwizzleKernel(swizzleSsse3);
+  return SwizzleKernel(swizzleNeon);
+}
+
+void BgraToRgba(uint8_t *Dst, const uint8_t *Src, int Pixels)
+{
+  // initialized once, thread safe
+  static const tBgraToRgba bgraToRgba = BestKernel();
+  bgraToRgba(Dst, Src, Pixels);
+}
+
+void BgraToRgba(uint8_t *Dst, const uint8_t *Src, int Pixels, eSwizzleKernel Kernel)
+{
+  if (Kernel == swizzleAuto)
+     BgraToRgba(Dst, Src, Pixels);
+  else
+     SwizzleKernel(Kernel)(Dst, Src, Pixels);
+}
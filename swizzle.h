@@ -0,0 +1,21 @@
+#ifndef __DBUS2VDR_SWIZZLE_H
+#define __DBUS2VDR_SWIZZLE_H
+
+#include <stdint.h>
+
+// conversion of vdr's pixels to PNG without dependencies on vdr, so the
+// benchmark (see "make bench") can use the same code as the plugin
+
+enum eSwizzleKernel { swizzleScalar, swizzleSsse3, swizzleNeon, swizzleAuto };
+
+// vdr's tColor is ARGB in host byte order, on little endian machines
+// that's B, G, R, A in memory, PNG wants R, G, B, A,
+// converts with the fastest kernel of this cpu
+void BgraToRgba(uint8_t *Dst, const uint8_t *Src, int Pixels);
+
+// for the benchmark, a kernel which isn't available falls back to swizzleScalar
+void BgraToRgba(uint8_t *Dst, const uint8_t *Src, int Pixels, eSwizzleKernel Kernel);
+bool SwizzleKernelAvailable(eSwizzleKernel Kernel);
+const char *SwizzleKernelName(eSwizzleKernel Kernel);
+
+#endif
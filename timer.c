@@ -1,7 +1,11 @@
 #include "timer.h"
 #include "common.h"
 #include "helper.h"
+#include "network.h"
+#include "status.h"
 
+#include <vdr/device.h>
+#include <vdr/status.h>
 #include <vdr/timers.h>
 
 // Id
@@ -21,6 +25,303 @@
 // InVpsMargin  
 #define TimerDBusStruct "isussiiiissubbb"
 
+// Start
+// Stop
+// Ids of failing timers
+// Ids of competing timers
+#define TimerConflictDBusStruct "ttaiai"
+
+
+// one occurrence of an active local timer within the conflict horizon
+typedef struct {
+  int     id;
+  int     priority;
+  time_t  start;
+  time_t  stop;
+  int     source;
+  int     transponder;
+  guint32 devices; // bit mask of devices which are able to receive the channel
+} tDBusTimerOccurrence;
+
+class cDBusTimerConflict : public cListObject
+{
+public:
+  time_t       start;
+  time_t       stop;
+  cVector<int> failed;
+  cVector<int> competing;
+
+  cDBusTimerConflict(time_t Start, time_t Stop)
+   :start(Start), stop(Stop) {};
+};
+
+// a set of overlapping occurrences; only these can compete for devices,
+// so the result is cached by the contents of the set
+class cDBusTimerConflictCluster : public cListObject
+{
+private:
+  gchar *_key;
+
+  static bool SameTransponder(const tDBusTimerOccurrence *A, const tDBusTimerOccurrence *B)
+  {
+    return (A->source == B->source) && ISTRANSPONDER(A->transponder, B->transponder);
+  };
+
+public:
+  cList<cDBusTimerConflict> conflicts;
+
+  cDBusTimerConflictCluster(gchar *Key)
+   :_key(Key) {};
+  virtual ~cDBusTimerConflictCluster(void) { g_free(_key); };
+
+  const char *Key(void) const { return _key; };
+
+  static gchar *CreateKey(const tDBusTimerOccurrence *Occurrences, int Count)
+  {
+    GString *key = g_string_new(NULL);
+    for (int i = 0; i < Count; i++) {
+        const tDBusTimerOccurrence *o = Occurrences + i;
+        g_string_append_printf(key, "%d:%d:%ld:%ld:%d:%d:%x;", o->id, o->priority, (long)o->start, (long)o->stop, o->source, o->transponder, o->devices);
+        }
+    return g_string_free(key, FALSE);
+  };
+
+  // assigns the occurrences (sorted by start time and priority) to the devices
+  // like vdr would do: timers on the same transponder share a device, a timer
+  // with a higher priority preempts timers with lower priorities
+  void Simulate(const tDBusTimerOccurrence *Occurrences, int Count)
+  {
+    cVector<int> running[MAXDEVICES];
+    for (int i = 0; i < Count; i++) {
+        const tDBusTimerOccurrence *o = Occurrences + i;
+        for (int d = 0; d < MAXDEVICES; d++) {
+            for (int r = running[d].Size() - 1; r >= 0; r--) {
+                if (Occurrences[running[d][r]].stop <= o->start)
+                   running[d].Remove(r);
+                }
+            }
+
+        int device = -1;
+        for (int d = 0; (device < 0) && (d < MAXDEVICES); d++) {
+            if (((o->devices & (1 << d)) != 0) && (running[d].Size() > 0) && SameTransponder(Occurrences + running[d][0], o))
+               device = d;
+            }
+        for (int d = 0; (device < 0) && (d < MAXDEVICES); d++) {
+            if (((o->devices & (1 << d)) != 0) && (running[d].Size() == 0))
+               device = d;
+            }
+        for (int d = 0; (device < 0) && (d < MAXDEVICES); d++) {
+            if ((o->devices & (1 << d)) == 0)
+               continue;
+            bool lower = true;
+            for (int r = 0; lower && (r < running[d].Size()); r++)
+                lower = Occurrences[running[d][r]].priority < o->priority;
+            if (lower) {
+               device = d;
+               for (int r = 0; r < running[d].Size(); r++) {
+                   const tDBusTimerOccurrence *p = Occurrences + running[d][r];
+                   cDBusTimerConflict *conflict = new cDBusTimerConflict(o->start, p->stop);
+                   conflict->failed.Append(p->id);
+                   conflict->competing.Append(o->id);
+                   conflicts.Add(conflict);
+                   }
+               running[d].Clear();
+               }
+            }
+
+        if (device >= 0)
+           running[device].Append(i);
+        else {
+           cDBusTimerConflict *conflict = new cDBusTimerConflict(o->start, o->stop);
+           conflict->failed.Append(o->id);
+           for (int d = 0; d < MAXDEVICES; d++) {
+               if ((o->devices & (1 << d)) == 0)
+                  continue;
+               for (int r = 0; r < running[d].Size(); r++)
+                   conflict->competing.AppendUnique(Occurrences[running[d][r]].id);
+               }
+           conflicts.Add(conflict);
+           }
+        }
+  };
+};
+
+class cDBusTimerConflicts : public cStatus
+{
+private:
+  cMutex _mutex;
+  cMutex _dirtyMutex;
+  bool   _dirty;
+  int    _horizon;
+  time_t _calculated;
+  cList<cDBusTimerConflictCluster> _clusters;
+
+  static int CompareOccurrences(gconstpointer A, gconstpointer B)
+  {
+    const tDBusTimerOccurrence *a = (const tDBusTimerOccurrence*)A;
+    const tDBusTimerOccurrence *b = (const tDBusTimerOccurrence*)B;
+    if (a->start != b->start)
+       return a->start < b->start ? -1 : 1;
+    if (a->priority != b->priority)
+       return a->priority > b->priority ? -1 : 1;
+    return a->id - b->id;
+  };
+
+  static void AddOccurrences(GArray *Occurrences, const cTimer *Timer, time_t Now, time_t Horizon)
+  {
+    if (!Timer->HasFlags(tfActive) || (Timer->Channel() == NULL))
+       return;
+#if VDRVERSNUM > 20300
+    if (Timer->Remote() != NULL)
+       return;
+#endif
+
+    tDBusTimerOccurrence o;
+    o.id = Timer->Index() + 1;
+#if VDRVERSNUM > 20300
+    o.id = Timer->Id();
+#endif
+    o.priority = Timer->Priority();
+    o.source = Timer->Channel()->Source();
+    o.transponder = Timer->Channel()->Transponder();
+    o.devices = 0;
+    for (int i = 0; (i < cDevice::NumDevices()) && (i < MAXDEVICES); i++) {
+        cDevice *device = cDevice::GetDevice(i);
+        if ((device != NULL) && device->ProvidesTransponder(Timer->Channel()))
+           o.devices |= 1 << i;
+        }
+
+    int startSecs = cTimer::TimeToInt(Timer->Start());
+    int duration = cTimer::TimeToInt(Timer->Stop()) - startSecs;
+    if (duration <= 0)
+       duration += SECSINDAY;
+
+    if (Timer->IsSingleEvent()) {
+       o.start = cTimer::SetTime(Timer->Day(), startSecs);
+       o.stop = o.start + duration;
+       if ((o.stop > Now) && (o.start < Horizon))
+          g_array_append_val(Occurrences, o);
+       return;
+       }
+
+    // start one day back to catch occurrences running over midnight
+    for (time_t day = cTimer::IncDay(cTimer::SetTime(Now, 0), -1); day < Horizon; day = cTimer::IncDay(day, 1)) {
+        if (((Timer->Day() != 0) && (day < Timer->Day())) || !Timer->DayMatches(day))
+           continue;
+        o.start = cTimer::SetTime(day, startSecs);
+        o.stop = o.start + duration;
+        if ((o.stop > Now) && (o.start < Horizon))
+           g_array_append_val(Occurrences, o);
+        }
+  };
+
+  void Calculate(time_t Now, int Horizon)
+  {
+    GArray *occurrences = g_array_new(FALSE, FALSE, sizeof(tDBusTimerOccurrence));
+    {
+#if VDRVERSNUM > 20300
+    LOCK_TIMERS_READ;
+    LOCK_CHANNELS_READ;
+    const cTimers *timers = Timers;
+#else
+    const cTimers *timers = &Timers;
+#endif
+    for (const cTimer *t = timers->First(); t; t = timers->Next(t))
+        AddOccurrences(occurrences, t, Now, Now + Horizon);
+    }
+    g_array_sort(occurrences, CompareOccurrences);
+
+    const tDBusTimerOccurrence *o = (const tDBusTimerOccurrence*)occurrences->data;
+    int count = occurrences->len;
+    int reused = 0;
+    cList<cDBusTimerConflictCluster> clusters;
+    int first = 0;
+    while (first < count) {
+          int last = first + 1;
+          time_t stop = o[first].stop;
+          while ((last < count) && (o[last].start < stop)) {
+                if (o[last].stop > stop)
+                   stop = o[last].stop;
+                last++;
+                }
+
+          gchar *key = cDBusTimerConflictCluster::CreateKey(o + first, last - first);
+          cDBusTimerConflictCluster *cluster = NULL;
+          for (cluster = _clusters.First(); cluster; cluster = _clusters.Next(cluster)) {
+              if (strcmp(cluster->Key(), key) == 0)
+                 break;
+              }
+          if (cluster != NULL) {
+             _clusters.Del(cluster, false);
+             g_free(key);
+             reused++;
+             }
+          else {
+             cluster = new cDBusTimerConflictCluster(key);
+             cluster->Simulate(o + first, last - first);
+             }
+          clusters.Add(cluster);
+          first = last;
+          }
+    g_array_free(occurrences, TRUE);
+
+    _clusters.Clear();
+    while (cDBusTimerConflictCluster *cluster = clusters.First()) {
+          clusters.Del(cluster, false);
+          _clusters.Add(cluster);
+          }
+    _horizon = Horizon;
+    _calculated = Now;
+    d4syslog("dbus2vdr: timer conflicts: %d occurrences in %d sets, %d sets reused", count, _clusters.Count(), reused);
+  };
+
+protected:
+  virtual void TimerChange(const cTimer *Timer, eTimerChange Change)
+  {
+    // don't take _mutex here, the caller may hold the timers lock
+    cMutexLock MutexLock(&_dirtyMutex);
+    _dirty = true;
+  };
+
+public:
+  cDBusTimerConflicts(void)
+   :_dirty(true), _horizon(0), _calculated(0) {};
+  virtual ~cDBusTimerConflicts(void) {};
+
+  int Get(int Horizon, GVariantBuilder *Array)
+  {
+    cMutexLock MutexLock(&_mutex);
+    time_t now = time(NULL);
+    bool dirty = false;
+    {
+    cMutexLock DirtyLock(&_dirtyMutex);
+    dirty = _dirty;
+    _dirty = false;
+    }
+    // recalculate at least once a minute to drop expired occurrences
+    // and pick up new occurrences of repeating timers
+    if (dirty || (Horizon != _horizon) || (now - _calculated >= 60))
+       Calculate(now, Horizon);
+
+    int count = 0;
+    for (cDBusTimerConflictCluster *cluster = _clusters.First(); cluster; cluster = _clusters.Next(cluster)) {
+        for (cDBusTimerConflict *c = cluster->conflicts.First(); c; c = cluster->conflicts.Next(c)) {
+            GVariantBuilder *failed = g_variant_builder_new(G_VARIANT_TYPE("ai"));
+            GVariantBuilder *competing = g_variant_builder_new(G_VARIANT_TYPE("ai"));
+            for (int i = 0; i < c->failed.Size(); i++)
+                g_variant_builder_add(failed, "i", c->failed[i]);
+            for (int i = 0; i < c->competing.Size(); i++)
+                g_variant_builder_add(competing, "i", c->competing[i]);
+            g_variant_builder_add(Array, "(ttaiai)", (guint64)c->start, (guint64)c->stop, failed, competing);
+            g_variant_builder_unref(failed);
+            g_variant_builder_unref(competing);
+            count++;
+            }
+        }
+    return count;
+  };
+};
+
 namespace cDBusTimersHelper
 {
   static const char *_xmlNodeInfoConst =
@@ -42,6 +343,12 @@ namespace cDBusTimersHelper
     "      <arg name=\"stop\"      type=\"t\" direction=\"out\"/>\n"
     "      <arg name=\"title\"     type=\"s\" direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"Conflicts\">\n"
+    "      <arg name=\"horizon\"      type=\"i\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+    "      <arg name=\"conflicts\"    type=\"a("TimerConflictDBusStruct")\" direction=\"out\"/>\n"
+    "    </method>\n"
     "  </interface>\n"
     "</node>\n";
 
@@ -60,12 +367,26 @@ namespace cDBusTimersHelper
     "      <arg name=\"replycode\"      type=\"i\"  direction=\"out\"/>\n"
     "      <arg name=\"replymessage\"   type=\"s\"  direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"NewBatch\">\n"
+    "      <arg name=\"timers\"         type=\"as\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"      type=\"i\"  direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\"   type=\"s\"  direction=\"out\"/>\n"
+    "      <arg name=\"ids\"            type=\"ai\" direction=\"out\"/>\n"
+    "    </method>\n"
+    "    <method name=\"DeleteBatch\">\n"
+    "      <arg name=\"numbers\"        type=\"ai\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"      type=\"i\"  direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\"   type=\"s\"  direction=\"out\"/>\n"
+    "    </method>\n"
     "    <method name=\"List\">\n"
     "      <arg name=\"timer\"     type=\"as\" direction=\"out\"/>\n"
     "    </method>\n"
     "    <method name=\"ListDetailed\">\n"
     "      <arg name=\"timer\"     type=\"a("TimerDBusStruct")\" direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"ListRemote\">\n"
+    "      <arg name=\"timer\"     type=\"a(ss)\" direction=\"out\"/>\n"
+    "    </method>\n"
     "    <method name=\"Next\">\n"
     "      <arg name=\"replycode\" type=\"i\" direction=\"out\"/>\n"
     "      <arg name=\"number\"    type=\"i\" direction=\"out\"/>\n"
@@ -74,9 +395,37 @@ namespace cDBusTimersHelper
     "      <arg name=\"stop\"      type=\"t\" direction=\"out\"/>\n"
     "      <arg name=\"title\"     type=\"s\" direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"Conflicts\">\n"
+    "      <arg name=\"horizon\"      type=\"i\" direction=\"in\"/>\n"
+    "      <arg name=\"replycode\"    type=\"i\" direction=\"out\"/>\n"
+    "      <arg name=\"replymessage\" type=\"s\" direction=\"out\"/>\n"
+    "      <arg name=\"conflicts\"    type=\"a("TimerConflictDBusStruct")\" direction=\"out\"/>\n"
+    "    </method>\n"
     "  </interface>\n"
     "</node>\n";
 
+  static cDBusListIndex<cTimer> _index;
+
+  static cMutex               _conflictsMutex;
+  static int                  _conflictsRefCount = 0;
+  static cDBusTimerConflicts *_conflicts = NULL;
+
+  static void AttachConflicts(void)
+  {
+    cMutexLock MutexLock(&_conflictsMutex);
+    if (_conflictsRefCount++ == 0)
+       _conflicts = new cDBusTimerConflicts;
+  }
+
+  static void DetachConflicts(void)
+  {
+    cMutexLock MutexLock(&_conflictsMutex);
+    if (--_conflictsRefCount == 0) {
+       delete _conflicts;
+       _conflicts = NULL;
+       }
+  }
+
   static void AddTimer(GVariantBuilder *Array, const cTimer *Timer)
   {
     if (Timer == NULL)
@@ -169,6 +518,165 @@ namespace cDBusTimersHelper
 #endif
   }
 
+  static void SendBatchReply(GDBusMethodInvocation *Invocation, int ReplyCode, const char *ReplyMessage, GVariantBuilder *Ids)
+  {
+    GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(isai)"));
+    g_variant_builder_add(builder, "i", ReplyCode);
+    g_variant_builder_add(builder, "s", ReplyMessage);
+    if (Ids != NULL)
+       g_variant_builder_add_value(builder, g_variant_builder_end(Ids));
+    else
+       g_variant_builder_add_value(builder, g_variant_new_array(G_VARIANT_TYPE_INT32, NULL, 0));
+    g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
+    g_variant_builder_unref(builder);
+  };
+
+  static void AddChange(GVariantBuilder *Changes, const cTimer *Timer, const char *Change)
+  {
+    cString text = Timer->ToText(true);
+    g_variant_builder_add(Changes, "(ss)", stripspace((char*)*text), Change);
+  };
+
+  static void NewBatch(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariantIter *iter = NULL;
+    g_variant_get(Parameters, "(as)", &iter);
+    cVector<cTimer*> newTimers;
+    const char *option = NULL;
+    cString error;
+    while (g_variant_iter_next(iter, "&s", &option)) {
+          cTimer *timer = new cTimer;
+          newTimers.Append(timer);
+          if (!*option) {
+             error = cString::sprintf("Missing settings of timer %d", newTimers.Size());
+             break;
+             }
+          if (!timer->Parse(option)) {
+             error = cString::sprintf("Error in settings of timer %d", newTimers.Size());
+             break;
+             }
+          }
+    g_variant_iter_free(iter);
+
+    if ((*error == NULL) && (newTimers.Size() == 0))
+       error = "Missing timer settings";
+    if (*error != NULL) {
+       for (int i = 0; i < newTimers.Size(); i++)
+           delete newTimers[i];
+       SendBatchReply(Invocation, 501, *error, NULL);
+       return;
+       }
+
+    GVariantBuilder *ids = g_variant_builder_new(G_VARIANT_TYPE("ai"));
+    GVariantBuilder *changes = g_variant_builder_new(G_VARIANT_TYPE("a(ss)"));
+    {
+    cTimers *timers = NULL;
+#if VDRVERSNUM > 20300
+    LOCK_TIMERS_WRITE;
+    timers = Timers;
+#else
+    timers = &Timers;
+#endif
+    cDBusStatus::StartTimerBatch();
+    for (int i = 0; i < newTimers.Size(); i++) {
+        cTimer *timer = newTimers[i];
+        timer->ClrFlags(tfRecording);
+        timers->Add(timer);
+        isyslog("timer %s added", *timer->ToDescr());
+        // same numbering as DeleteBatch and ListDetailed
+#if VDRVERSNUM > 20300
+        g_variant_builder_add(ids, "i", timer->Id());
+#else
+        g_variant_builder_add(ids, "i", timer->Index() + 1);
+#endif
+        AddChange(changes, timer, "tcAdd");
+        }
+#if VDRVERSNUM < 20300
+    timers->SetModified();
+#endif
+    }
+    cDBusStatus::FinishTimerBatch(g_variant_new("(a(ss))", changes));
+    SendBatchReply(Invocation, 250, *cString::sprintf("%d timers added", newTimers.Size()), ids);
+    g_variant_builder_unref(changes);
+    g_variant_builder_unref(ids);
+  };
+
+  static void DeleteBatch(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariantIter *iter = NULL;
+    g_variant_get(Parameters, "(ai)", &iter);
+    cVector<int> numbers;
+    int number = 0;
+    while (g_variant_iter_next(iter, "i", &number))
+          numbers.AppendUnique(number);
+    g_variant_iter_free(iter);
+
+    if (numbers.Size() == 0) {
+       cDBusHelper::SendReply(Invocation, 501, "Missing timer numbers");
+       return;
+       }
+
+    GVariantBuilder *changes = g_variant_builder_new(G_VARIANT_TYPE("a(ss)"));
+    cVector<cTimer*> delTimers;
+    {
+#if VDRVERSNUM > 20300
+    LOCK_TIMERS_WRITE;
+    Timers->SetExplicitModify();
+    for (int i = 0; i < numbers.Size(); i++) {
+        cTimer *timer = Timers->GetById(numbers[i]);
+        if (timer == NULL) {
+           cDBusHelper::SendReply(Invocation, 501, *cString::sprintf("Timer \"%d\" not defined", numbers[i]));
+           g_variant_builder_unref(changes);
+           return;
+           }
+        delTimers.Append(timer);
+        }
+
+    cDBusStatus::StartTimerBatch();
+    for (int i = 0; i < delTimers.Size(); i++) {
+        cTimer *timer = delTimers[i];
+        AddChange(changes, timer, "tcDel");
+        if (timer->Recording())
+           timer->Skip();
+        Timers->Del(timer);
+        }
+    Timers->SetModified();
+#else
+    if (Timers.BeingEdited()) {
+       cDBusHelper::SendReply(Invocation, 550, "Timers are being edited - try again later");
+       g_variant_builder_unref(changes);
+       return;
+       }
+    for (int i = 0; i < numbers.Size(); i++) {
+        cTimer *timer = Timers.Get(numbers[i] - 1);
+        if (timer == NULL) {
+           cDBusHelper::SendReply(Invocation, 501, *cString::sprintf("Timer \"%d\" not defined", numbers[i]));
+           g_variant_builder_unref(changes);
+           return;
+           }
+        if (timer->Recording()) {
+           cDBusHelper::SendReply(Invocation, 550, *cString::sprintf("Timer \"%d\" is recording", numbers[i]));
+           g_variant_builder_unref(changes);
+           return;
+           }
+        delTimers.Append(timer);
+        }
+
+    cDBusStatus::StartTimerBatch();
+    for (int i = 0; i < delTimers.Size(); i++) {
+        cTimer *timer = delTimers[i];
+        isyslog("deleting timer %s", *timer->ToDescr());
+        AddChange(changes, timer, "tcDel");
+        Timers.Del(timer);
+        }
+    Timers.SetModified();
+#endif
+    }
+    cDBusStatus::FinishTimerBatch(g_variant_new("(a(ss))", changes));
+    cDBusHelper::SendReply(Invocation, 250, *cString::sprintf("%d timers deleted", delTimers.Size()));
+    g_variant_builder_unref(changes);
+  };
+
   static void List(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
     GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(as)"));
@@ -183,8 +691,10 @@ namespace cDBusTimersHelper
 #else
     timers = &Timers;
 #endif
-    for (int i = 0; i < timers->Count(); i++) {
-        const cTimer *timer = timers->Get(i);
+    cDBusListIndex<cTimer>::cLock IndexLock(_index);
+    _index.Update(timers);
+    for (int i = 0; i < _index.Count(); i++) {
+        const cTimer *timer = _index.Get(i);
         if (timer) {
            text = timer->ToText(true);
            tmp = stripspace((char*)*text);
@@ -210,8 +720,10 @@ namespace cDBusTimersHelper
 #else
     timers = &Timers;
 #endif
-    for (int i = 0; i < timers->Count(); i++)
-        AddTimer(array, timers->Get(i));
+    cDBusListIndex<cTimer>::cLock IndexLock(_index);
+    _index.Update(timers);
+    for (int i = 0; i < _index.Count(); i++)
+        AddTimer(array, _index.Get(i));
     
     g_variant_builder_add_value(builder, g_variant_builder_end(array));
     g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
@@ -219,6 +731,19 @@ namespace cDBusTimersHelper
     g_variant_builder_unref(builder);
   };
 
+  static void ListRemote(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(a(ss))"));
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(ss)"));
+
+    cDBusNetworkClient::GetRemoteTimers(array);
+
+    g_variant_builder_add_value(builder, g_variant_builder_end(array));
+    g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
+    g_variant_builder_unref(array);
+    g_variant_builder_unref(builder);
+  };
+
   static void Next(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
   {
     int returncode = 250;
@@ -257,6 +782,30 @@ namespace cDBusTimersHelper
     g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
     g_variant_builder_unref(builder);
   };
+
+  static void Conflicts(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    int horizon = 0;
+    g_variant_get(Parameters, "(i)", &horizon);
+    if (horizon <= 0)
+       horizon = 7 * SECSINDAY;
+
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a("TimerConflictDBusStruct")"));
+    int count = 0;
+    {
+    cMutexLock MutexLock(&_conflictsMutex);
+    if (_conflicts != NULL)
+       count = _conflicts->Get(horizon, array);
+    }
+
+    GVariantBuilder *builder = g_variant_builder_new(G_VARIANT_TYPE("(isa("TimerConflictDBusStruct"))"));
+    g_variant_builder_add(builder, "i", 250);
+    g_variant_builder_add(builder, "s", *cString::sprintf("%d conflicts", count));
+    g_variant_builder_add_value(builder, g_variant_builder_end(array));
+    g_dbus_method_invocation_return_value(Invocation, g_variant_builder_end(builder));
+    g_variant_builder_unref(array);
+    g_variant_builder_unref(builder);
+  };
 }
 
 
@@ -266,6 +815,8 @@ cDBusTimersConst::cDBusTimersConst(const char *NodeInfo)
   AddMethod("List", cDBusTimersHelper::List);
   AddMethod("ListDetailed", cDBusTimersHelper::ListDetailed);
   AddMethod("Next", cDBusTimersHelper::Next);
+  AddMethod("Conflicts", cDBusTimersHelper::Conflicts);
+  cDBusTimersHelper::AttachConflicts();
 }
 
 cDBusTimersConst::cDBusTimersConst(void)
@@ -274,10 +825,13 @@ cDBusTimersConst::cDBusTimersConst(void)
   AddMethod("List", cDBusTimersHelper::List);
   AddMethod("ListDetailed", cDBusTimersHelper::ListDetailed);
   AddMethod("Next", cDBusTimersHelper::Next);
+  AddMethod("Conflicts", cDBusTimersHelper::Conflicts);
+  cDBusTimersHelper::AttachConflicts();
 }
 
 cDBusTimersConst::~cDBusTimersConst(void)
 {
+  cDBusTimersHelper::DetachConflicts();
 }
 
 cDBusTimers::cDBusTimers(void)
@@ -285,6 +839,9 @@ cDBusTimers::cDBusTimers(void)
 {
   AddMethod("New", cDBusTimersHelper::New);
   AddMethod("Delete", cDBusTimersHelper::Delete);
+  AddMethod("NewBatch", cDBusTimersHelper::NewBatch);
+  AddMethod("DeleteBatch", cDBusTimersHelper::DeleteBatch);
+  AddMethod("ListRemote", cDBusTimersHelper::ListRemote);
 }
 
 cDBusTimers::~cDBusTimers(void)
@@ -0,0 +1,199 @@
+#include "utf8.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#define UTF8_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define UTF8_AVX2
+#include <immintrin.h>
+#endif
+
+typedef const unsigned char *(*tSkipAscii)(const unsigned char *c);
+
+// the kernels skip the leading run of 7-bit ascii characters and return a pointer
+// to the first non-ascii character or to the terminating null byte,
+// the vector loads are aligned, so they never cross a page boundary
+
+static const unsigned char *SkipAsciiScalar(const unsigned char *c)
+{
+  // eight bytes per step
+  while ((((uintptr_t)c) & 7) != 0) {
+        if ((*c == 0) || (*c & 0x80))
+           return c;
+        c++;
+        }
+  while (true) {
+        uint64_t v;
+        memcpy(&v, c, sizeof(v));
+        if (((v & 0x8080808080808080ULL) != 0) || (((v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL) != 0))
+           break;
+        c += 8;
+        }
+  while ((*c != 0) && !(*c & 0x80))
+        c++;
+  return c;
+}
+
+#ifdef UTF8_SSE2
+static const unsigned char *SkipAsciiSse2(const unsigned char *c)
+{
+  while ((((uintptr_t)c) & 15) != 0) {
+        if ((*c == 0) || (*c & 0x80))
+           return c;
+        c++;
+        }
+  const __m128i zero = _mm_setzero_si128();
+  while (true) {
+        __m128i v = _mm_load_si128((const __m128i*)c);
+        int stop = _mm_movemask_epi8(v) | _mm_movemask_epi8(_mm_cmpeq_epi8(v, zero));
+        if (stop != 0)
+           return c + __builtin_ctz(stop);
+        c += 16;
+        }
+}
+#endif
+
+#ifdef UTF8_AVX2
+__attribute__((target("avx2")))
+static const unsigned char *SkipAsciiAvx2(const unsigned char *c)
+{
+  while ((((uintptr_t)c) & 31) != 0) {
+        if ((*c == 0) || (*c & 0x80))
+           return c;
+        c++;
+        }
+  const __m256i zero = _mm256_setzero_si256();
+  while (true) {
+        __m256i v = _mm256_load_si256((const __m256i*)c);
+        unsigned int stop = (unsigned int)_mm256_movemask_epi8(v) | (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, zero));
+        if (stop != 0)
+           return c + __builtin_ctz(stop);
+        c += 32;
+        }
+}
+#endif
+
+// checks the multi-byte sequences one by one, the runs of ascii characters
+// are skipped with the kernels, without kernels it's the old byte by byte loop
+static bool Validate(const char *Text, tSkipAscii SkipFirst, tSkipAscii SkipAscii)
+{
+  int nb = 0;
+  const unsigned char *c = (const unsigned char*)Text;
+  if (SkipFirst != NULL)
+     c = SkipFirst(c);
+
+  while (*c) {
+        if ((*c & 0x80) == 0x00) {
+           if (SkipAscii != NULL)
+              c = SkipAscii(c);
+           else
+              c++;
+           continue;
+           }
+        else if ((*c & 0xc0) == 0x80)
+           return false;
+        else if ((*c & 0xe0) == 0xc0)
+           nb = 1;
+        else if ((*c & 0xf0) == 0xe0)
+           nb = 2;
+        else if ((*c & 0xf8) == 0xf0)
+           nb = 3;
+        else if ((*c & 0xfc) == 0xf8)
+           nb = 4;
+        else if ((*c & 0xfe) == 0xfc)
+           nb = 5;
+        else
+           return false;
+        // a truncated sequence fails here, since the terminating null byte is no continuation byte
+        for (int na = 1; na <= nb; na++) {
+            if ((c[na] & 0xc0) != 0x80)
+               return false;
+            }
+        c += (nb + 1);
+        }
+  return true;
+}
+
+bool Utf8KernelAvailable(eUtf8Kernel Kernel)
+{
+  switch (Kernel) {
+    case utf8Bytewise:
+    case utf8Scalar:
+    case utf8Auto:
+      return true;
+    case utf8Sse2:
+#ifdef UTF8_SSE2
+      return true;
+#else
+      return false;
+#endif
+    case utf8Avx2:
+#ifdef UTF8_AVX2
+      return __builtin_cpu_supports("avx2");
+#else
+      return false;
+#endif
+    }
+  return false;
+}
+
+const char *Utf8KernelName(eUtf8Kernel Kernel)
+{
+  switch (Kernel) {
+    case utf8Bytewise: return "bytewise";
+    case utf8Scalar:   return "scalar";
+    case utf8Sse2:     return "sse2";
+    case utf8Avx2:     return "avx2";
+    case utf8Auto:     return "auto";
+    }
+  return "unknown";
+}
+
+static tSkipAscii SkipAsciiKernel(eUtf8Kernel Kernel)
+{
+  if (!Utf8KernelAvailable(Kernel))
+     return SkipAsciiScalar;
+  switch (Kernel) {
+    case utf8Bytewise:
+      return NULL;
+#ifdef UTF8_SSE2
+    case utf8Sse2:
+      return SkipAsciiSse2;
+#endif
+#ifdef UTF8_AVX2
+    case utf8Avx2:
+      return SkipAsciiAvx2;
+#endif
+    default:
+      break;
+    }
+  return SkipAsciiScalar;
+}
+
+static tSkipAscii WidestKernel(void)
+{
+  if (Utf8KernelAvailable(utf8Avx2))
+     return SkipAsciiKernel(utf8Avx2);
+  return SkipAsciiKernel(utf8Sse2);
+}
+
+bool Utf8IsValid(const char *Text)
+{
+  // initialized once, thread safe
+  static const tSkipAscii skipFirst = WidestKernel();
+  static const tSkipAscii skipAscii = SkipAsciiKernel(utf8Sse2);
+  return Validate(Text, skipFirst, skipAscii);
+}
+
+bool Utf8IsValid(const char *Text, eUtf8Kernel Kernel)
+{
+  if (Kernel == utf8Auto)
+     return Utf8IsValid(Text);
+  tSkipAscii skipAscii = SkipAsciiKernel(Kernel);
+  return Validate(Text, skipAscii, skipAscii);
+}
@@ -0,0 +1,20 @@
+#ifndef __DBUS2VDR_UTF8_H
+#define __DBUS2VDR_UTF8_H
+
+// UTF-8 validation without dependencies on vdr, so the benchmark
+// (see "make bench") can use the same code as the plugin
+
+// utf8Auto is the one used by the plugin, it skips the leading run of ascii
+// characters with the widest vectors of this cpu and the usually short runs
+// between the multi-byte characters with SSE2
+enum eUtf8Kernel { utf8Bytewise, utf8Scalar, utf8Sse2, utf8Avx2, utf8Auto };
+
+// checks a null terminated string with utf8Auto
+bool Utf8IsValid(const char *Text);
+
+// for the benchmark, a kernel which isn't available falls back to utf8Scalar
+bool Utf8IsValid(const char *Text, eUtf8Kernel Kernel);
+bool Utf8KernelAvailable(eUtf8Kernel Kernel);
+const char *Utf8KernelName(eUtf8Kernel Kernel);
+
+#endif
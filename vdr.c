@@ -16,6 +16,9 @@ namespace cDBusVdrHelper
     "    <method name=\"Status\">\n"
     "      <arg name=\"status\"       type=\"s\" direction=\"out\"/>\n"
     "    </method>\n"
+    "    <method name=\"MethodStatistics\">\n"
+    "      <arg name=\"methods\"      type=\"a(ssbuuuu)\" direction=\"out\"/>\n"
+    "    </method>\n"
     "    <signal name=\"Start\">\n"
     "      <arg name=\"instanceid\"  type=\"i\"/>\n"
     "    </signal>\n"
@@ -47,11 +50,17 @@ namespace cDBusVdrHelper
   {
     g_dbus_method_invocation_return_value(Invocation, g_variant_new("(s)", GetStatusName(cDBusVdr::GetStatus())));
   };
+
+  static void MethodStatistics(cDBusObject *Object, GVariant *Parameters, GDBusMethodInvocation *Invocation)
+  {
+    GVariantBuilder *array = g_variant_builder_new(G_VARIANT_TYPE("a(ssbuuuu)"));
+    cDBusObject::GetMethodStatistics(array);
+    g_dbus_method_invocation_return_value(Invocation, g_variant_new("(a(ssbuuuu))", array));
+    g_variant_builder_unref(array);
+  };
 }
 
 cDBusVdr::eVdrStatus  cDBusVdr::_status = cDBusVdr::statusUnknown;
-cVector<cDBusVdr*>    cDBusVdr::_objects;
-cMutex                cDBusVdr::_objectsMutex;
 
 bool  cDBusVdr::SetStatus(cDBusVdr::eVdrStatus Status)
 {
@@ -61,10 +70,7 @@ bool  cDBusVdr::SetStatus(cDBusVdr::eVdrStatus Status)
   _status = Status;
   const char *signal = cDBusVdrHelper::GetStatusName(_status);
 
-  _objectsMutex.Lock();
-  for (int i = 0; i < _objects.Size(); i++)
-      _objects[i]->Connection()->EmitSignal(new cDBusSignal(NULL, "/vdr", DBUS_VDR_VDR_INTERFACE, signal, g_variant_new("(i)", InstanceId), NULL, NULL));
-  _objectsMutex.Unlock();
+  cDBusObject::EmitSignal("/vdr", DBUS_VDR_VDR_INTERFACE, signal, g_variant_new("(i)", InstanceId));
   return true;
 }
 
@@ -76,22 +82,10 @@ cDBusVdr::eVdrStatus cDBusVdr::GetStatus(void)
 cDBusVdr::cDBusVdr(void)
 :cDBusObject("/vdr", cDBusVdrHelper::_xmlNodeInfo)
 {
-  AddMethod("Status", cDBusVdrHelper::Status);
-  _objectsMutex.Lock();
-  _objects.Append(this);
-  _objectsMutex.Unlock();
+  AddMethod("Status", cDBusVdrHelper::Status, true);
+  AddMethod("MethodStatistics", cDBusVdrHelper::MethodStatistics);
 }
 
 cDBusVdr::~cDBusVdr(void)
 {
-  _objectsMutex.Lock();
-  int i = 0;
-  while (i < _objects.Size()) {
-        if (_objects[i] == this) {
-           _objects.Remove(i);
-           break;
-           }
-        i++;
-        }
-  _objectsMutex.Unlock();
 }
@@ -17,8 +17,6 @@ public:
 
 private:
   static eVdrStatus         _status;
-  static cVector<cDBusVdr*> _objects;
-  static cMutex             _objectsMutex;
 };
 
 #endif